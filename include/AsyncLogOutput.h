@@ -0,0 +1,90 @@
+#pragma once
+#include <Arduino.h>
+#include <atomic>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include "settings.h"
+
+/**
+ * Print backend for ArduinoLog that never waits for the UART.
+ * Every write() is copied into a lock-free multi-producer ring buffer and a low
+ * priority task drains it to the real output. When the ring is full the text is
+ * dropped and counted instead of blocking the caller; the drain task reports the
+ * count once there is room again.
+ *
+ * Each line is stored as a record: a one byte header (length, plus a committed bit)
+ * followed by the bytes. Producers reserve space with a compare-and-swap and publish
+ * the header last, so writers on both cores never wait on each other or on the drain.
+ * ArduinoLog prints a message piece by piece, mostly one character at a time, so writes
+ * are staged per task until the end of the line (or MAX_RECORD bytes) and appended at
+ * once: a line is either queued whole or dropped whole, and records are not one byte
+ * each. Lines longer than a record are split; once a piece is dropped, so is the rest
+ * of the line.
+ */
+class AsyncLogOutput : public Print {
+public:
+    struct Stats {
+        uint32_t droppedWrites;
+        uint32_t droppedBytes;
+        uint32_t highWatermark; // Most bytes ever queued
+    };
+
+    /**
+     * @param output Destination drained by the task, typically Serial.
+     */
+    explicit AsyncLogOutput(Print& output);
+
+    /**
+     * Starts the drain task. Writes before begin() are queued and sent once it runs.
+     */
+    void begin();
+
+    size_t write(uint8_t c) override;
+    size_t write(const uint8_t* buffer, size_t size) override;
+    using Print::write;
+
+    /**
+     * Queues the unfinished line of the calling task, waits until everything queued has
+     * been handed to the output, then flushes it.
+     * Blocks, so only for before sleeping or restarting.
+     */
+    void flush() override;
+
+    Stats getStats() const;
+
+private:
+    static constexpr uint32_t CAPACITY = ASYNC_LOG_BUFFER_SIZE;
+    static constexpr uint32_t MASK = CAPACITY - 1;
+    static constexpr uint8_t COMMITTED = 0x80;
+    static constexpr uint8_t MAX_RECORD = 0x7F;
+    static_assert((CAPACITY & MASK) == 0, "ASYNC_LOG_BUFFER_SIZE must be a power of two");
+
+    /**
+     * Line being written by one task. Claimed on its first write, released once its line
+     * is queued; tasks that find no free stage append their writes directly.
+     */
+    struct Stage {
+        std::atomic<TaskHandle_t> owner{nullptr};
+        uint8_t length = 0;
+        bool dropping = false; // A piece of the current line was dropped
+        uint8_t data[MAX_RECORD];
+    };
+
+    Print& output;
+    uint8_t ring[CAPACITY];
+    std::atomic<uint32_t> reserved{0};  // Bytes reserved by producers since start
+    std::atomic<uint32_t> consumed{0};  // Bytes released by the drain task since start
+    std::atomic<uint32_t> droppedWrites{0};
+    std::atomic<uint32_t> droppedBytes{0};
+    std::atomic<uint32_t> highWatermark{0};
+    uint32_t reportedDrops = 0;
+    TaskHandle_t task = nullptr;
+    Stage stages[ASYNC_LOG_STAGES];
+
+    Stage* stageOfCurrentTask();
+    void stage(Stage& stage, uint8_t c);
+    void commit(Stage& stage, bool endOfLine);
+    bool append(const uint8_t* data, uint8_t length);
+    size_t drain();
+    static void taskEntry(void* arg);
+};
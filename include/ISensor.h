@@ -4,6 +4,8 @@
 #include "SensorExceptions.h"
 #include "ResultCode.h"
 #include "SensorResult.h"
+#include "FieldSchema.h"
+#include "settings.h"
 
 class ISensor {
 
@@ -48,6 +50,62 @@ class ISensor {
          */
         virtual SensorResult readValues(bool force = false, bool updateReadTime = true) = 0;
 
+        /**
+         * Time left before the sensor is due for its next read.
+         * Used by SensorManager to decide how long the device may sleep.
+         * @return Milliseconds until the next scheduled read, 0 if already due.
+         */
+        virtual unsigned long millisUntilNextRead() const {
+            unsigned long elapsed = millis() - lastReadTime;
+            return elapsed >= updateInterval ? 0 : updateInterval - elapsed;
+        }
+
+        /**
+         * Whether update() must run on every loop iteration (e.g. while sampling a signal).
+         * As long as any sensor returns true the device is kept awake.
+         */
+        virtual bool requiresContinuousSampling() const {
+            return false;
+        }
+
+        /**
+         * GPIO that should wake the device from light sleep while it is low (e.g. a latched
+         * active-low interrupt line). SensorManager arms it only for the duration of the sleep.
+         * @return -1 if the sensor has no wakeup line.
+         */
+        virtual int8_t wakeupPin() const {
+            return -1;
+        }
+
+        /**
+         * Longest time a non-empty readValues() is expected to take. SensorManager quarantines
+         * a sensor whose reads keep taking longer, so it does not slow down the others.
+         * Sensors that block by design (e.g. capturing a window of samples) raise it.
+         */
+        virtual uint32_t readTimeBudgetUs() const {
+            return SENSOR_READ_BUDGET_US;
+        }
+
+        /**
+         * Describes how each field produced by readValues() is stored while buffered.
+         * Fields not listed are kept as float.
+         * @param count Set to the number of entries in the returned array.
+         * @return Static array of field descriptions, nullptr if the sensor declares none.
+         */
+        virtual const FieldSchema* getFieldSchema(uint8_t& count) const {
+            count = 0;
+            return nullptr;
+        }
+
+        /**
+         * Receives the latest reading of a sensor this one depends on (see
+         * SensorManager::addDependency), right before readValues() in the same tick.
+         * The reading is the producer's cached result, so no extra hardware read happens.
+         * @param producer Sensor that produced the reading.
+         * @param reading Its most recent non-empty result.
+         */
+        virtual void onDependencyReading(const ISensor& producer, const SensorResult& reading) {}
+
         /**
          * Get the name of the sensor.
          * @return Name of the sensor.
@@ -1,17 +1,104 @@
 #pragma once
-#include <InfluxDbClient.h>
-#include <InfluxDbCloud.h>
+#include <vector>
 #include "settings.h"
 #include <SensorResult.h>
+#include <ReadingBuffer.h>
+#include <EncodedBatch.h>
+#include <LogSink.h>
+#include <climits>
+#include <InfluxHttpStream.h>
 
+/**
+ * Buffers sensor readings, encodes them once in InfluxDB line protocol and
+ * fans the encoded batch out to every registered sink.
+ */
 class InfluxLogger {
 public:
     InfluxLogger(const char* deviceName, bool simulated = false);
+
+    /**
+     * Registers a destination for the encoded batches. Must be called before begin().
+     */
+    void addSink(LogSink* sink);
+
     void begin();
+
+    /**
+     * Buffers the result locally with the current timestamp.
+     * Nothing is sent until flush() is called, unless one of its fields is an
+     * alarm (see FieldSchema::isUrgent): then the reading is encoded on its own
+     * and queued on the priority lane of every sink right away.
+     */
     void logSensorResult(const SensorResult& result);
-    void flush();
+
+    /**
+     * Encodes the oldest buffered readings into one batch and queues it on every sink.
+     * The batch holds at most the number of points chosen by the batch controllers;
+     * the remaining readings stay buffered for the next flush.
+     * Sending happens asynchronously in the sink tasks.
+     * @return Size of the encoded batch in bytes.
+     */
+    size_t flush();
+
+    /**
+     * Uploads the oldest buffered readings (all of them, up to INFLUX_STREAM_MAX_POINTS) to
+     * InfluxDB in one request, encoding them straight from the buffer into the stream, and
+     * removes them once InfluxDB accepted the request, or refused it for good (HTTP 4xx, see
+     * InfluxHttpSink::isRejection()); after any other failure they stay buffered.
+     * Unlike flush() it blocks until the response, and the readings go to InfluxDB only,
+     * not to the sinks.
+     * @return Bytes written to the stream.
+     */
+    size_t streamBacklog(InfluxHttpStream& stream);
+
+    /**
+     * Delay before the next flush, tuned from the latency and failures of previous sends:
+     * the shortest among the network sinks, so a failing sink does not slow down the others.
+     */
+    unsigned long nextFlushDelayMs() const;
+
+    /**
+     * Whether a full batch is buffered and the sinks that are delivering are down to their
+     * last batch: flushing again right away, rather than after nextFlushDelayMs(), keeps the
+     * backlog from growing when readings come in faster than one batch per interval, while
+     * no more than two batches wait in the queues.
+     */
+    bool hasBacklog() const;
+
+    /**
+     * @return true if every sink that needs the network failed its last send.
+     */
+    bool networkSinksFailing() const;
+
+    /**
+     * Waits until every sink that needs the network has sent its queue.
+     * @return false on timeout.
+     */
+    bool waitForNetworkSinks(unsigned long timeoutMs);
+
+    /**
+     * @return true if a sink still has alarms to send.
+     */
+    bool hasUrgentPending() const;
+
+    void logSinkStats() const;
+
+    size_t bufferedReadings() const { return buffer.countReadings(); }
+    size_t bufferedBytes() const { return buffer.usedBytes(); }
 private:
-    InfluxDBClient client;
+    ReadingBuffer buffer;
+    std::vector<LogSink*> sinks;
     const char* deviceName;
     const bool simulated; // If true, does not log to InfluxDB but simulates the logging process
+    uint32_t skippedReadings = 0; // Readings with no finite field (line protocol cannot carry them), counted when popped
+
+    uint16_t batchSize() const;
+    bool encodeReading(const ReadingBuffer::Cursor& cursor, String& out);
+    void sendUrgent(const SensorResult& result, int64_t timestampMs);
+    static bool isUrgent(const SensorResult& result);
+    void appendRecordStart(String& out, const char* sensorName) const;
+    static bool appendField(String& out, bool first, const char* key, float value, int decimals);
+    static void appendTimestamp(String& out, int64_t timestampMs);
+    static void appendEscaped(String& out, const char* value, const char* specialChars);
+    static int64_t currentTimeMs();
 };
@@ -0,0 +1,38 @@
+#pragma once
+#include <Arduino.h>
+#include <WebServer.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include "settings.h"
+#include "ReadingsSnapshot.h"
+
+/**
+ * Lightweight HTTP endpoint exposing the latest readings for pull-based scraping.
+ * GET /metrics returns the Prometheus text format, GET /json the same data as JSON
+ * (without the NaN and infinite values, which JSON cannot represent).
+ * Requests are served from a dedicated task and read the ReadingsSnapshot only,
+ * so a scrape never blocks sampling nor triggers a hardware read.
+ */
+class MetricsServer {
+public:
+    MetricsServer(const ReadingsSnapshot& snapshot, const char* deviceName, uint16_t port = METRICS_SERVER_PORT);
+
+    /**
+     * Starts listening and the task serving requests. WiFi must be up.
+     */
+    void begin();
+
+private:
+    const ReadingsSnapshot& snapshot;
+    const char* deviceName;
+    const uint16_t port;
+    WebServer server;
+    TaskHandle_t task = nullptr;
+    ReadingsSnapshot::Field fields[READINGS_SNAPSHOT_MAX_FIELDS];
+
+    void handlePrometheus();
+    void handleJson();
+    static void appendPrometheusValue(String& out, float value);
+    static void appendEscaped(String& out, const char* value);
+    static void taskEntry(void* arg);
+};
@@ -0,0 +1,55 @@
+#pragma once
+#include <Arduino.h>
+#include <WiFiMulti.h>
+#include "settings.h"
+
+/**
+ * Owns the WiFi radio and brings it up only when data has to be sent.
+ * Reconnection is delegated to WiFiMulti; the time it takes and the bytes sent
+ * on each wake are recorded to evaluate the duty cycle.
+ */
+class RadioManager {
+public:
+    struct Stats {
+        uint32_t wakeCount = 0;
+        uint32_t failedWakes = 0;
+        uint32_t lastReconnectMs = 0;
+        uint32_t totalReconnectMs = 0;
+        size_t lastUploadBytes = 0;
+        uint64_t totalUploadBytes = 0;
+    };
+
+    RadioManager(const char* ssid, const char* password);
+
+    void begin();
+
+    /**
+     * Turns the radio on and waits for WiFiMulti to connect.
+     * Returns immediately if already connected.
+     * @param timeoutMs Maximum time to wait for the connection.
+     * @return true if connected.
+     */
+    bool wake(unsigned long timeoutMs = RADIO_CONNECT_TIMEOUT);
+
+    /**
+     * Disconnects and turns the radio off.
+     */
+    void sleep();
+
+    bool isAwake() const { return awake; }
+
+    /**
+     * Records the payload sent during the current wake.
+     */
+    void recordUpload(size_t bytes);
+
+    const Stats& getStats() const { return stats; }
+    void logStats() const;
+
+private:
+    WiFiMulti wifiMulti;
+    const char* ssid;
+    const char* password;
+    bool awake = false;
+    Stats stats;
+};
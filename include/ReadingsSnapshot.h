@@ -0,0 +1,99 @@
+#pragma once
+#include <Arduino.h>
+#include <atomic>
+#include "settings.h"
+#include "SensorResult.h"
+
+/**
+ * Latest value of every field produced by the sensors, readable from other tasks.
+ * The table is protected by a seqlock: the single writer (the sampling loop) never
+ * waits, readers copy the table and retry if a write happened meanwhile.
+ */
+class ReadingsSnapshot {
+public:
+    struct Field {
+        const char* sensorName;
+        char key[SENSORENTRY_MAX_KEY_LEN];
+        float value;
+        unsigned long updatedAt; // millis() of the last update
+    };
+
+    /**
+     * Stores the values of a result. Called only from the sampling loop.
+     * Fields beyond READINGS_SNAPSHOT_MAX_FIELDS are ignored.
+     */
+    void update(const SensorResult& result) {
+        unsigned long now = millis();
+        uint8_t entries = result.countEntries();
+
+        beginWrite();
+        for (uint8_t i = 0; i < entries; i++) {
+            const char* key = result.getKey(i);
+            Field* field = find(result.getSensorName(), key);
+            if (field == nullptr) {
+                if (count >= READINGS_SNAPSHOT_MAX_FIELDS) continue;
+                field = &fields[count];
+                field->sensorName = result.getSensorName();
+                strncpy(field->key, key, SENSORENTRY_MAX_KEY_LEN - 1);
+                field->key[SENSORENTRY_MAX_KEY_LEN - 1] = '\0';
+                count++;
+            }
+            field->value = result.getValue(i);
+            field->updatedAt = now;
+        }
+        endWrite();
+    }
+
+    /**
+     * Copies a consistent view of the table. Safe to call from any task.
+     * @param out Destination, must hold READINGS_SNAPSHOT_MAX_FIELDS fields.
+     * @return Number of fields copied.
+     */
+    size_t read(Field* out) const {
+        for (;;) {
+            uint32_t before = sequence.load(std::memory_order_acquire);
+            if (before & 1) { // Write in progress, let the writer finish
+                delay(1);
+                continue;
+            }
+            size_t n = count;
+            memcpy(out, fields, n * sizeof(Field));
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (sequence.load(std::memory_order_relaxed) == before) return n;
+        }
+    }
+
+    /**
+     * Visits the fields in place, without copying. Called only from the sampling loop,
+     * which is the only writer.
+     */
+    template<typename Visitor>
+    void forEach(Visitor&& visit) const {
+        for (size_t i = 0; i < count; i++) {
+            visit(fields[i]);
+        }
+    }
+
+private:
+    Field fields[READINGS_SNAPSHOT_MAX_FIELDS];
+    size_t count = 0;
+    std::atomic<uint32_t> sequence{0};
+
+    void beginWrite() {
+        sequence.fetch_add(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+    }
+
+    void endWrite() {
+        sequence.fetch_add(1, std::memory_order_release);
+    }
+
+    Field* find(const char* sensorName, const char* key) {
+        for (size_t i = 0; i < count; i++) {
+            if (fields[i].sensorName == sensorName && strcmp(fields[i].key, key) == 0) {
+                return &fields[i];
+            }
+        }
+        return nullptr;
+    }
+};
@@ -2,21 +2,84 @@
 #include <Arduino.h>
 #include <ArduinoLog.h>
 #include <vector>
+#include <climits>
+#include <esp_sleep.h>
+#include <driver/gpio.h>
+#include <esp_timer.h>
 #include "ISensor.h"
 #include "ResultCode.h"
 #include "SensorResult.h"
 #include "SensorExceptions.h"
+#include "ReadingsSnapshot.h"
+#include "WindowedStats.h"
+#include "Backoff.h"
 
 class SensorManager {
 public:
+    /**
+     * Failure and latency tracking of a sensor, see SENSOR_QUARANTINE_FAILURES.
+     */
+    struct Health {
+        uint32_t failures = 0;
+        uint32_t slowReads = 0;
+        uint8_t consecutiveFailures = 0;
+        uint8_t consecutiveSlowReads = 0;
+        uint32_t lastReadUs = 0;
+        uint32_t maxReadUs = 0;
+        bool quarantined = false;
+        uint32_t quarantines = 0;
+        unsigned long quarantinedAt = 0;
+        unsigned long probeAt = 0; // millis() of the next probe while quarantined
+        Backoff probeBackoff{SENSOR_PROBE_BACKOFF_MIN_MS, SENSOR_PROBE_BACKOFF_MAX_MS};
+    };
+
     struct SensorInstance {
         ISensor* sensor;
         bool throwOnInitializationError;
         bool throwOnUpdateError;
+        SensorResult latest;           // Last non-empty result, handed to dependent sensors
+        std::vector<size_t> producers; // Indexes of the sensors this one depends on
+        uint8_t dependents;            // Number of sensors depending on this one
+        unsigned long latestAt;        // millis() of the last non-empty result, 0 if none yet
+        Health health;
+    };
+
+    struct SleepStats {
+        uint32_t sleepCount = 0;
+        uint64_t totalRequestedUs = 0;  // Sum of the requested sleep durations
+        uint64_t totalSleptUs = 0;      // Sum of the measured time spent in light sleep
+        uint32_t lastWakeLatencyUs = 0; // Overshoot of the last wakeup past its deadline
+        uint32_t maxWakeLatencyUs = 0;
+        int64_t sinceUs = 0;            // Start of the accounting period (esp_timer time)
     };
 
     void addSensor(ISensor* sensor, bool throwOnInitializationError = true, bool throwOnUpdateError = true) {
-        sensors.push_back({sensor, throwOnInitializationError, throwOnUpdateError});
+        sensors.push_back({sensor, throwOnInitializationError, throwOnUpdateError, SensorResult(sensor->getSensorName()), {}, 0, 0});
+        orderValid = false;
+    }
+
+    /**
+     * Declares that consumer uses the readings of producer (e.g. temperature compensation).
+     * Within readAll() producers are read before their consumers, and each consumer gets the
+     * producer's latest reading through ISensor::onDependencyReading() before it is read.
+     * Both sensors must be added to the manager first. A dependency on a sensor that is not
+     * registered, or that would close a cycle, is logged and ignored.
+     * @return false if the dependency was ignored.
+     */
+    bool addDependency(ISensor* consumer, ISensor* producer) {
+        if (indexOf(consumer) == sensors.size() || indexOf(producer) == sensors.size()) {
+            Log.error(F("Dependency ignored: %s or %s is not added to the sensor manager\n"),
+                      consumer ? consumer->getSensorName() : "null", producer ? producer->getSensorName() : "null");
+            return false;
+        }
+        if (dependsOn(producer, consumer)) {
+            Log.error(F("Dependency ignored: %s already depends on %s, the dependencies would form a cycle\n"),
+                      producer->getSensorName(), consumer->getSensorName());
+            return false;
+        }
+        dependencies.push_back({consumer, producer});
+        orderValid = false;
+        return true;
     }
 
     void beginAll() {
@@ -34,8 +97,15 @@ public:
         }
     }
 
+    /**
+     * Updates every sensor, except the quarantined ones.
+     * A failed hardware read (SensorReadException) is logged and counted towards the
+     * sensor's quarantine, never propagated; throwOnUpdateError only propagates
+     * SensorNotInitializedException.
+     */
     void updateAll() {
-        for (const SensorInstance& entry : sensors) {
+        for (SensorInstance& entry : sensors) {
+            if (entry.health.quarantined) continue;
             try {
                 entry.sensor->update();
             } catch (const SensorNotInitializedException& e) {
@@ -44,12 +114,16 @@ public:
                     Log.fatal(F("Critical sensor update error, propagating exception.\n"));
                     throw;
                 }
+            } catch (const SensorReadException& e) {
+                Log.error(F("Sensor update error: %s\n"), e.what());
+                recordOutcome(entry, true, 0); // Quarantines the sensor if it keeps failing
             }
         }
     }
 
     void logAllValues() {
         for (const SensorInstance& entry : sensors) {
+            if (entry.health.quarantined) continue;
             Log.notice(F("Logging values from sensor: %s\n"), entry.sensor->getSensorName());
             try {
                 SensorResult result = entry.sensor->readValues();
@@ -63,10 +137,6 @@ public:
                 }
             } catch (const SensorReadException& e) {
                 Log.error(F("Sensor read error: %s\n"), e.what());
-                if (entry.throwOnUpdateError) {
-                    Log.fatal(F("Critical sensor read error, propagating exception.\n"));
-                    throw;
-                }
             }
         }
     }
@@ -74,34 +144,58 @@ public:
     /**
      * Reads all sensor values by calling readValues() on each sensor.
      * Returns a vector of SensorResult, one for each sensor.
-     * Throws if an exception is not handled internally.
+     * Quarantined sensors are skipped, except when their probe is due: they are then read
+     * with force, and released if the read succeeds within their time budget.
+     * Read failures are handled as in updateAll(); SensorNotInitializedException propagates.
      */
     std::vector<SensorResult> readAll(bool forceRead = false, bool updateReadTime = true) {
+        if (!orderValid) sortByDependencies();
         std::vector<SensorResult> results;
-        for (const SensorInstance& entry : sensors) {
+        for (size_t index : readOrder) {
+            SensorInstance& entry = sensors[index];
             if (entry.sensor == nullptr) {
                 Log.error(F("Null sensor pointer detected in SensorManager::readAll(). Skipping.\n"));
                 continue;
             }
+            bool probing = entry.health.quarantined;
+            if (probing && static_cast<long>(millis() - entry.health.probeAt) < 0) continue;
             try {
-                SensorResult result = entry.sensor->readValues(forceRead, updateReadTime);
-                if(result.isEmpty()) continue; // Not time to read or no data available
+                for (size_t producer : entry.producers) {
+                    const SensorInstance& source = sensors[producer];
+                    if (!source.latest.isEmpty()) {
+                        entry.sensor->onDependencyReading(*source.sensor, source.latest);
+                    }
+                }
+                int64_t start = esp_timer_get_time();
+                SensorResult result = entry.sensor->readValues(forceRead || probing, updateReadTime);
+                uint32_t elapsedUs = static_cast<uint32_t>(esp_timer_get_time() - start);
+                if (result.isEmpty()) { // Not time to read or no data available
+                    // A probe without data (e.g. still calibrating) waits for the next one
+                    if (probing) entry.health.probeAt = millis() + entry.health.probeBackoff.next();
+                    continue;
+                }
+                recordOutcome(entry, false, elapsedUs);
+                uint8_t schemaCount;
+                const FieldSchema* schema = entry.sensor->getFieldSchema(schemaCount);
+                result.setSchema(schema, schemaCount);
+                snapshot.update(result);
+                entry.latestAt = millis();
+                windowStats.update(result);
+                if (entry.dependents > 0) entry.latest = result;
                 results.push_back(result);
                 Log.verboseln(F("Sensor %s read successfully."), entry.sensor->getSensorName());
             } catch (const SensorReadException& e) {
                 Log.error(F("Sensor read error: %s\n"), e.what());
-                if (entry.throwOnUpdateError) {
-                    Log.fatal(F("Critical sensor read error, propagating exception.\n"));
-                    throw;
-                }
+                recordOutcome(entry, true, 0);
             }
         }
         return results;
     }
 
     /**
-     * Reads all sensor values and logs them to the console.
-     * This is a convenience method that combines readAll() and logging.
+     * Forces a fresh read of all sensors and logs the values to the console.
+     * This is a convenience method that combines readAll() and logging; to log what the
+     * sampling loop already read, without touching the hardware, use logLatestValues().
      * Throws if an exception is not handled internally.
      */
     void readAndLogAllValues() {
@@ -113,8 +207,320 @@ public:
         Log.notice(F("--- END SENSOR LOG ---\n"));
     }
 
+    /**
+     * Logs the latest values read by readAll(), and their age, from the snapshot.
+     * Does not read the sensors.
+     */
+    void logLatestValues() const {
+        Log.notice(F("\n--- START SENSOR LOG ---\n"));
+        unsigned long now = millis();
+        for (const SensorInstance& entry : sensors) {
+            if (entry.sensor == nullptr) continue;
+            const char* name = entry.sensor->getSensorName();
+            if (entry.latestAt == 0) {
+                Log.notice(F("%s: no reading yet%s\n"), name, entry.health.quarantined ? ", quarantined" : "");
+                continue;
+            }
+            Log.notice(F("%s (%u ms ago%s):\n"), name, now - entry.latestAt, entry.health.quarantined ? ", quarantined" : "");
+            snapshot.forEach([name](const ReadingsSnapshot::Field& field) {
+                if (field.sensorName == name) Log.notice(F("%s: %F\n"), field.key, field.value);
+            });
+        }
+        Log.notice(F("--- END SENSOR LOG ---\n"));
+    }
+
+    /**
+     * Time since the last non-empty result of a sensor, ULONG_MAX if it was never read
+     * (or was not added to the manager).
+     */
+    unsigned long latestAgeMs(const ISensor* sensor) const {
+        for (const SensorInstance& entry : sensors) {
+            if (entry.sensor == sensor) return entry.latestAt == 0 ? ULONG_MAX : millis() - entry.latestAt;
+        }
+        return ULONG_MAX;
+    }
+
+    /**
+     * Computes the time until the earliest sensor deadline.
+     * Returns 0 if any sensor requires continuous sampling or is already due.
+     */
+    unsigned long millisUntilNextDeadline() const {
+        unsigned long next = ULONG_MAX;
+        for (const SensorInstance& entry : sensors) {
+            if (entry.sensor == nullptr) continue;
+            unsigned long remaining;
+            if (entry.health.quarantined) {
+                long untilProbe = static_cast<long>(entry.health.probeAt - millis());
+                remaining = untilProbe > 0 ? untilProbe : 0;
+            } else {
+                if (entry.sensor->requiresContinuousSampling()) return 0;
+                remaining = entry.sensor->millisUntilNextRead();
+            }
+            if (remaining < next) next = remaining;
+        }
+        return next;
+    }
+
+    /**
+     * Output flushed before entering light sleep, besides Serial, e.g. an AsyncLogOutput
+     * whose task would otherwise still be writing to the UART.
+     */
+    void setLogOutput(Print* output) {
+        logOutput = output;
+    }
+
+    /**
+     * Enters light sleep until the earliest sensor deadline or maxSleepMs, whichever comes first.
+     * Does nothing if the idle time is shorter than LIGHT_SLEEP_MIN_MS.
+     * Sensors with a wakeup line (see ISensor::wakeupPin()) also wake the device early.
+     * @param maxSleepMs Upper bound for the sleep, typically the time left to the next flush.
+     * @return The time actually spent sleeping, in ms.
+     */
+    unsigned long sleepUntilNextDeadline(unsigned long maxSleepMs) {
+        unsigned long sleepMs = millisUntilNextDeadline();
+        if (maxSleepMs < sleepMs) sleepMs = maxSleepMs;
+        if (sleepMs < LIGHT_SLEEP_MIN_MS) return 0;
+
+        if (sleepStats.sinceUs == 0) sleepStats.sinceUs = esp_timer_get_time();
+
+        // A wakeup line already low is an event waiting to be handled, not a reason to sleep
+        for (const SensorInstance& entry : sensors) {
+            int8_t pin = entry.sensor->wakeupPin();
+            if (pin >= 0 && digitalRead(pin) == LOW) return 0;
+        }
+
+        uint64_t requestedUs = static_cast<uint64_t>(sleepMs) * 1000ULL;
+        // Pending UART output would be lost while sleeping, queued log lines included
+        if (logOutput != nullptr) logOutput->flush();
+        Serial.flush();
+        esp_sleep_enable_timer_wakeup(requestedUs);
+        bool gpioWakeup = armWakeupPins(true);
+        if (gpioWakeup) esp_sleep_enable_gpio_wakeup();
+        int64_t start = esp_timer_get_time();
+        esp_light_sleep_start();
+        uint64_t sleptUs = static_cast<uint64_t>(esp_timer_get_time() - start);
+        if (gpioWakeup) {
+            esp_sleep_disable_wakeup_source(ESP_SLEEP_WAKEUP_GPIO);
+            armWakeupPins(false);
+        }
+
+        sleepStats.sleepCount++;
+        sleepStats.totalRequestedUs += requestedUs;
+        sleepStats.totalSleptUs += sleptUs;
+        // Early wakeups (GPIO) are not latency, only the overshoot past the deadline is
+        sleepStats.lastWakeLatencyUs = sleptUs > requestedUs ? static_cast<uint32_t>(sleptUs - requestedUs) : 0;
+        if (sleepStats.lastWakeLatencyUs > sleepStats.maxWakeLatencyUs) {
+            sleepStats.maxWakeLatencyUs = sleepStats.lastWakeLatencyUs;
+        }
+        return static_cast<unsigned long>(sleptUs / 1000ULL);
+    }
+
+    /**
+     * Latest value of every field, safe to read from other tasks without blocking sampling.
+     */
+    const ReadingsSnapshot& getSnapshot() const {
+        return snapshot;
+    }
+
+    /**
+     * Min/max/avg of every field over recent windows, e.g.
+     * getWindowStats().query("MQ-135", "CO", 10 * 60000UL, summary).
+     */
+    const WindowedStats& getWindowStats() const {
+        return windowStats;
+    }
+
+    /**
+     * @return nullptr if the sensor was not added to the manager.
+     */
+    const Health* getHealth(const ISensor* sensor) const {
+        for (const SensorInstance& entry : sensors) {
+            if (entry.sensor == sensor) return &entry.health;
+        }
+        return nullptr;
+    }
+
+    /**
+     * Logs the sensors that failed or were slow at least once, and the quarantined ones.
+     */
+    void logHealth() const {
+        for (const SensorInstance& entry : sensors) {
+            const Health& health = entry.health;
+            if (health.failures == 0 && health.slowReads == 0) continue;
+            Log.notice(F("Sensor %s: %u failures, %u slow reads, read last %u us max %u us, %u quarantines%s\n"),
+                       entry.sensor->getSensorName(), health.failures, health.slowReads, health.lastReadUs,
+                       health.maxReadUs, health.quarantines, health.quarantined ? ", quarantined" : "");
+        }
+    }
+
+    const SleepStats& getSleepStats() const {
+        return sleepStats;
+    }
+
+    /**
+     * Logs the light sleep counters and the duty cycle since the first sleep.
+     */
+    void logSleepStats() const {
+        if (sleepStats.sleepCount == 0) return;
+        int64_t elapsedUs = esp_timer_get_time() - sleepStats.sinceUs;
+        float awakePercent = elapsedUs > 0 ? 100.0f * (1.0f - static_cast<float>(sleepStats.totalSleptUs) / elapsedUs) : 100.0f;
+        Log.notice(F("Light sleep: %u sleeps, %u ms slept, awake %F%%, wake latency last %u us max %u us\n"),
+                   sleepStats.sleepCount, static_cast<uint32_t>(sleepStats.totalSleptUs / 1000ULL), awakePercent,
+                   sleepStats.lastWakeLatencyUs, sleepStats.maxWakeLatencyUs);
+    }
+
 private:
+    struct Dependency {
+        ISensor* consumer;
+        ISensor* producer;
+    };
+
     std::vector<SensorInstance> sensors;
+    std::vector<Dependency> dependencies;
+    std::vector<size_t> readOrder; // Sensor indexes, producers before consumers
+    bool orderValid = false;
+    SleepStats sleepStats;
+    Print* logOutput = nullptr;
+    ReadingsSnapshot snapshot;
+    WindowedStats windowStats;
+
+    /**
+     * @return Index of the sensor, sensors.size() if it is not registered.
+     */
+    size_t indexOf(const ISensor* sensor) const {
+        for (size_t i = 0; i < sensors.size(); i++) {
+            if (sensors[i].sensor == sensor) return i;
+        }
+        return sensors.size();
+    }
+
+    /**
+     * Whether consumer depends on producer, directly or through other sensors
+     * (or is the same sensor).
+     */
+    bool dependsOn(const ISensor* consumer, const ISensor* producer) const {
+        if (consumer == producer) return true;
+        for (const Dependency& dependency : dependencies) {
+            if (dependency.consumer == consumer && dependsOn(dependency.producer, producer)) return true;
+        }
+        return false;
+    }
+
+    /**
+     * Resolves the dependencies and computes the read order with Kahn's algorithm.
+     * Among the sensors that are ready, the first registered is read first, so without
+     * dependencies the order is the registration order. addDependency() only accepts
+     * registered sensors and no cycle, so every sensor gets placed.
+     */
+    void sortByDependencies() {
+        std::vector<uint8_t> pending(sensors.size(), 0); // Producers not yet placed
+        for (SensorInstance& entry : sensors) {
+            entry.producers.clear();
+            entry.dependents = 0;
+        }
+        for (const Dependency& dependency : dependencies) {
+            size_t consumer = indexOf(dependency.consumer);
+            size_t producer = indexOf(dependency.producer);
+            sensors[consumer].producers.push_back(producer);
+            sensors[producer].dependents++;
+            pending[consumer]++;
+        }
+
+        readOrder.clear();
+        std::vector<bool> placed(sensors.size(), false);
+        while (readOrder.size() < sensors.size()) {
+            size_t next = sensors.size();
+            for (size_t i = 0; i < sensors.size(); i++) {
+                if (!placed[i] && pending[i] == 0) {
+                    next = i;
+                    break;
+                }
+            }
+            if (next == sensors.size()) {
+                Log.error(F("Sensor dependencies form a cycle, the remaining sensors are not read\n"));
+                break;
+            }
+            placed[next] = true;
+            readOrder.push_back(next);
+            for (size_t i = 0; i < sensors.size(); i++) {
+                for (size_t producer : sensors[i].producers) {
+                    if (producer == next) pending[i]--;
+                }
+            }
+        }
+        orderValid = true;
+    }
+
+    /**
+     * Switches the wakeup lines of the sensors to level triggered light sleep wakeup, or back
+     * to the falling edge interrupt their ISR expects once awake. A level interrupt left on a
+     * latched line would fire continuously until the sensor clears it.
+     * @return true if at least one sensor has a wakeup line.
+     */
+    bool armWakeupPins(bool arm) {
+        bool any = false;
+        for (const SensorInstance& entry : sensors) {
+            int8_t pin = entry.sensor->wakeupPin();
+            if (pin < 0) continue;
+            gpio_num_t gpio = static_cast<gpio_num_t>(pin);
+            if (arm) {
+                gpio_wakeup_enable(gpio, GPIO_INTR_LOW_LEVEL);
+            } else {
+                gpio_wakeup_disable(gpio);
+                gpio_set_intr_type(gpio, GPIO_INTR_NEGEDGE);
+            }
+            any = true;
+        }
+        return any;
+    }
+
+    /**
+     * Updates the health of a sensor after a read (or a failed update) and quarantines it,
+     * or releases it, accordingly.
+     * @param elapsedUs Duration of the read, ignored if it failed.
+     */
+    void recordOutcome(SensorInstance& entry, bool failed, uint32_t elapsedUs) {
+        Health& health = entry.health;
+        bool slow = !failed && elapsedUs > entry.sensor->readTimeBudgetUs();
+        if (failed) {
+            health.failures++;
+            if (health.consecutiveFailures < UINT8_MAX) health.consecutiveFailures++;
+        } else {
+            health.consecutiveFailures = 0;
+            health.lastReadUs = elapsedUs;
+            if (elapsedUs > health.maxReadUs) health.maxReadUs = elapsedUs;
+            if (slow) {
+                health.slowReads++;
+                if (health.consecutiveSlowReads < UINT8_MAX) health.consecutiveSlowReads++;
+            } else {
+                health.consecutiveSlowReads = 0;
+            }
+        }
+
+        if (health.quarantined) {
+            if (failed || slow) {
+                health.probeAt = millis() + health.probeBackoff.next();
+                Log.verboseln(F("Sensor %s probe failed, next in %u ms."), entry.sensor->getSensorName(),
+                              health.probeBackoff.currentDelay());
+            } else {
+                health.quarantined = false;
+                health.probeBackoff.reset();
+                Log.notice(F("Sensor %s recovered after %u ms in quarantine\n"), entry.sensor->getSensorName(),
+                           millis() - health.quarantinedAt);
+            }
+            return;
+        }
+
+        if (health.consecutiveFailures >= SENSOR_QUARANTINE_FAILURES || health.consecutiveSlowReads >= SENSOR_QUARANTINE_SLOW_READS) {
+            health.quarantined = true;
+            health.quarantines++;
+            health.quarantinedAt = millis();
+            health.probeAt = health.quarantinedAt + health.probeBackoff.next();
+            Log.warning(F("Sensor %s quarantined after %u failed and %u slow reads in a row, probing again in %u ms\n"),
+                        entry.sensor->getSensorName(), health.consecutiveFailures, health.consecutiveSlowReads,
+                        health.probeBackoff.currentDelay());
+        }
+    }
 
     void logSensorResult(const SensorResult& result) {
         uint8_t keysCount = result.countEntries();
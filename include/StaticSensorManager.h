@@ -0,0 +1,194 @@
+#pragma once
+#include <Arduino.h>
+#include <ArduinoLog.h>
+#include <array>
+#include <climits>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "ISensor.h"
+#include "SensorResult.h"
+#include "SensorExceptions.h"
+#include "SensorManager.h"
+
+/**
+ * Compile-time alternative to SensorManager for a sensor set fixed in config.h.
+ * Sensors are held by reference in a tuple and visited with fold expressions;
+ * every call is qualified with the concrete sensor type, so there is no virtual
+ * dispatch and the drivers' hot paths can be inlined into the loop.
+ * SensorManager remains the option for sensors added at runtime.
+ *
+ * Usage:
+ *   StaticSensorManager<MPU6050Sensor, MQ135Sensor> staticSensors(mpu6050_1, mq135Sensor);
+ */
+template<typename... Sensors>
+class StaticSensorManager {
+    static_assert(sizeof...(Sensors) > 0, "StaticSensorManager needs at least one sensor");
+    static_assert((std::is_base_of_v<ISensor, Sensors> && ...), "All sensors must implement ISensor");
+
+public:
+    static constexpr size_t sensorCount = sizeof...(Sensors);
+
+    explicit StaticSensorManager(Sensors&... sensors) : sensors(sensors...) {}
+
+    /**
+     * Whether initialization and update/read errors are propagated (default) or only logged.
+     * There is no quarantine here: unlike SensorManager, failed hardware reads follow
+     * throwOnUpdateError too, from update() as from readValues().
+     */
+    void setErrorPolicy(bool throwOnInitializationError, bool throwOnUpdateError) {
+        throwOnInit = throwOnInitializationError;
+        throwOnUpdate = throwOnUpdateError;
+    }
+
+    void beginAll() {
+        forEach([this](auto& sensor) {
+            using Sensor = std::remove_reference_t<decltype(sensor)>;
+            Log.verboseln(F("Initializing sensor: %s"), sensor.getSensorName());
+            try {
+                sensor.Sensor::begin();
+            } catch (const SensorInitializationException& e) {
+                Log.error(F("Sensor init error: %s\n"), e.what());
+                if (throwOnInit) {
+                    Log.fatal(F("Critical sensor initialization error, propagating exception.\n"));
+                    throw;
+                }
+            }
+        });
+    }
+
+    void updateAll() {
+        forEach([this](auto& sensor) {
+            using Sensor = std::remove_reference_t<decltype(sensor)>;
+            try {
+                sensor.Sensor::update();
+            } catch (const SensorNotInitializedException& e) {
+                Log.error(F("Sensor update error: %s\n"), e.what());
+                if (throwOnUpdate) {
+                    Log.fatal(F("Critical sensor update error, propagating exception.\n"));
+                    throw;
+                }
+            } catch (const SensorReadException& e) {
+                Log.error(F("Sensor update error: %s\n"), e.what());
+                if (throwOnUpdate) {
+                    Log.fatal(F("Critical sensor update error, propagating exception.\n"));
+                    throw;
+                }
+            }
+        });
+    }
+
+    /**
+     * Reads every sensor and passes each non-empty result to onResult,
+     * without collecting them in a container.
+     */
+    template<typename Callback>
+    void readAll(Callback&& onResult, bool forceRead = false, bool updateReadTime = true) {
+        forEach([&](auto& sensor) {
+            using Sensor = std::remove_reference_t<decltype(sensor)>;
+            try {
+                SensorResult result = sensor.Sensor::readValues(forceRead, updateReadTime);
+                if (result.isEmpty()) return; // Not time to read or no data available
+                uint8_t schemaCount;
+                const FieldSchema* schema = sensor.Sensor::getFieldSchema(schemaCount);
+                result.setSchema(schema, schemaCount);
+                onResult(result);
+            } catch (const SensorReadException& e) {
+                Log.error(F("Sensor read error: %s\n"), e.what());
+                if (throwOnUpdate) {
+                    Log.fatal(F("Critical sensor read error, propagating exception.\n"));
+                    throw;
+                }
+            }
+        });
+    }
+
+    /**
+     * Same interface as SensorManager::readAll().
+     */
+    std::vector<SensorResult> readAll(bool forceRead = false, bool updateReadTime = true) {
+        std::vector<SensorResult> results;
+        results.reserve(sensorCount);
+        readAll([&results](SensorResult& result) { results.push_back(std::move(result)); }, forceRead, updateReadTime);
+        return results;
+    }
+
+    /**
+     * Time until the earliest sensor deadline, 0 if a sensor needs continuous sampling.
+     */
+    unsigned long millisUntilNextDeadline() const {
+        unsigned long next = ULONG_MAX;
+        bool continuous = false;
+        forEach([&](const auto& sensor) {
+            using Sensor = std::remove_cv_t<std::remove_reference_t<decltype(sensor)>>;
+            if (sensor.Sensor::requiresContinuousSampling()) continuous = true;
+            unsigned long remaining = sensor.Sensor::millisUntilNextRead();
+            if (remaining < next) next = remaining;
+        });
+        return continuous ? 0 : next;
+    }
+
+    void readAndLogAllValues() {
+        Log.notice(F("\n--- START SENSOR LOG ---\n"));
+        readAll([](const SensorResult& result) {
+            uint8_t keysCount = result.countEntries();
+            for (uint8_t i = 0; i < keysCount; i++) {
+                Log.notice(F("%s: %F\n"), result.getKey(i), result.getValue(i));
+            }
+        }, true, false);
+        Log.notice(F("--- END SENSOR LOG ---\n"));
+    }
+
+    /**
+     * Times a sampling loop iteration, updateAll() then readAll(), of manager against the
+     * same iteration through this manager, and logs the CPU cycles per loop. The manager
+     * must hold the same sensors, already initialized. The two paths alternate, so both see
+     * the sensors in the same state; the minimum is the dispatch cost of an idle loop, the
+     * average includes the reads that fell due. SensorManager also maintains the snapshot,
+     * the windowed statistics and the sensor health, which are part of its cost.
+     * @param loops Iterations timed on each path.
+     */
+    void benchmark(SensorManager& manager, uint16_t loops = STATIC_SENSOR_MANAGER_BENCHMARK_LOOPS) {
+        uint32_t dynamicMin = UINT32_MAX, staticMin = UINT32_MAX;
+        uint64_t dynamicTotal = 0, staticTotal = 0;
+        size_t dynamicResults = 0, staticResults = 0;
+
+        for (uint16_t i = 0; i < loops; i++) {
+            uint32_t start = ESP.getCycleCount();
+            manager.updateAll();
+            dynamicResults += manager.readAll().size();
+            uint32_t elapsed = ESP.getCycleCount() - start;
+            dynamicTotal += elapsed;
+            if (elapsed < dynamicMin) dynamicMin = elapsed;
+
+            start = ESP.getCycleCount();
+            updateAll();
+            readAll([&staticResults](const SensorResult&) { staticResults++; });
+            elapsed = ESP.getCycleCount() - start;
+            staticTotal += elapsed;
+            if (elapsed < staticMin) staticMin = elapsed;
+        }
+
+        if (loops == 0) return;
+        Log.notice(F("[StaticSensorManager] %u sensors, %u loops: SensorManager min %u avg %u cycles (%u results), "
+                     "static min %u avg %u cycles (%u results)" CR),
+                   sensorCount, loops, dynamicMin, static_cast<uint32_t>(dynamicTotal / loops), dynamicResults,
+                   staticMin, static_cast<uint32_t>(staticTotal / loops), staticResults);
+    }
+
+private:
+    std::tuple<Sensors&...> sensors;
+    bool throwOnInit = true;
+    bool throwOnUpdate = true;
+
+    template<typename Visitor>
+    void forEach(Visitor&& visit) {
+        std::apply([&visit](Sensors&... sensor) { (visit(sensor), ...); }, sensors);
+    }
+
+    template<typename Visitor>
+    void forEach(Visitor&& visit) const {
+        std::apply([&visit](const Sensors&... sensor) { (visit(sensor), ...); }, sensors);
+    }
+};
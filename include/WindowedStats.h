@@ -0,0 +1,230 @@
+#pragma once
+#include <Arduino.h>
+#include <ArduinoLog.h>
+#include <float.h>
+#include "settings.h"
+#include "SensorResult.h"
+
+/**
+ * Recent history of a single field, for min/max/avg queries over any window up to
+ * WINDOW_STATS_SPAN_MS. Values are aggregated into time buckets of WINDOW_STATS_SPAN_MS /
+ * WINDOW_STATS_BUCKETS kept in a ring, so memory is fixed whatever the sampling rate. The
+ * ring holds one bucket more than the span needs: the oldest bucket overlapping a full span
+ * window may have started up to one bucket before it. NaN and infinite values are ignored.
+ *
+ * Two monotonic deques of bucket numbers (decreasing maxima, increasing minima) give the
+ * extreme of any suffix of the ring with a binary search, and cumulative sums stored in
+ * each bucket give the average. Adding a value is O(1) amortized, a query O(log buckets).
+ */
+class FieldWindow {
+public:
+    struct Summary {
+        float min;
+        float max;
+        float avg;
+        uint32_t count; // Values in the window
+    };
+
+    static constexpr unsigned long BUCKET_MS = WINDOW_STATS_SPAN_MS / WINDOW_STATS_BUCKETS;
+    static_assert(BUCKET_MS > 0, "WINDOW_STATS_SPAN_MS must be at least WINDOW_STATS_BUCKETS ms");
+
+    void add(float value, unsigned long now) {
+        if (!isfinite(value)) return; // Would poison the sums and leave empty buckets
+        if (size == 0 || now - bucketAt(lastSeq()).startMs >= BUCKET_MS) {
+            openBucket(now);
+        }
+        uint32_t seq = lastSeq();
+        Bucket& bucket = bucketAt(seq);
+        totalSum += value;
+        totalCount++;
+
+        if (value > bucket.max) {
+            bucket.max = value;
+            // The current bucket is always at the back: move it past the maxima it now exceeds
+            maxDeque.popBack();
+            while (!maxDeque.empty() && bucketAt(maxDeque.back()).max <= value) maxDeque.popBack();
+            maxDeque.pushBack(seq);
+        }
+        if (value < bucket.min) {
+            bucket.min = value;
+            minDeque.popBack();
+            while (!minDeque.empty() && bucketAt(minDeque.back()).min >= value) minDeque.popBack();
+            minDeque.pushBack(seq);
+        }
+    }
+
+    /**
+     * Summarizes the values of the last windowMs milliseconds, with bucket granularity
+     * (the oldest bucket overlapping the window is counted whole). Windows longer than
+     * WINDOW_STATS_SPAN_MS are shortened to it.
+     * @return false if no value falls in the window.
+     */
+    bool query(unsigned long windowMs, unsigned long now, Summary& out) const {
+        if (size == 0) return false;
+        if (windowMs > WINDOW_STATS_SPAN_MS) windowMs = WINDOW_STATS_SPAN_MS;
+
+        // First bucket ending after the start of the window; bucket times increase with seq
+        uint32_t lo = firstSeq, hi = lastSeq() + 1;
+        while (lo < hi) {
+            uint32_t mid = lo + (hi - lo) / 2;
+            if (now - bucketAt(mid).startMs >= windowMs + BUCKET_MS) lo = mid + 1;
+            else hi = mid;
+        }
+        if (lo > lastSeq()) return false;
+
+        const Bucket& first = bucketAt(lo);
+        out.count = totalCount - first.countBefore;
+        out.avg = static_cast<float>((totalSum - first.sumBefore) / out.count);
+        out.max = bucketAt(maxDeque.firstAtLeast(lo)).max;
+        out.min = bucketAt(minDeque.firstAtLeast(lo)).min;
+        return true;
+    }
+
+private:
+    static constexpr size_t RING_BUCKETS = WINDOW_STATS_BUCKETS + 1;
+
+    struct Bucket {
+        unsigned long startMs;
+        float min;
+        float max;
+        double sumBefore;     // Sum of all values added before this bucket
+        uint32_t countBefore;
+    };
+
+    /**
+     * Ring of bucket numbers, in increasing order.
+     */
+    class SeqDeque {
+    public:
+        bool empty() const { return count == 0; }
+        uint32_t front() const { return items[start]; }
+        uint32_t back() const { return items[(start + count - 1) % RING_BUCKETS]; }
+        void pushBack(uint32_t seq) { items[(start + count++) % RING_BUCKETS] = seq; }
+        void popBack() { count--; }
+        void popFront() { start = (start + 1) % RING_BUCKETS; count--; }
+
+        /**
+         * Smallest bucket number >= seq. The newest bucket is always present, so it exists
+         * for any seq in the ring.
+         */
+        uint32_t firstAtLeast(uint32_t seq) const {
+            size_t lo = 0, hi = count - 1;
+            while (lo < hi) {
+                size_t mid = (lo + hi) / 2;
+                if (items[(start + mid) % RING_BUCKETS] < seq) lo = mid + 1;
+                else hi = mid;
+            }
+            return items[(start + lo) % RING_BUCKETS];
+        }
+
+    private:
+        uint32_t items[RING_BUCKETS];
+        size_t start = 0;
+        size_t count = 0;
+    };
+
+    Bucket buckets[RING_BUCKETS];
+    SeqDeque maxDeque;
+    SeqDeque minDeque;
+    uint32_t firstSeq = 0; // Number of the oldest bucket in the ring
+    size_t size = 0;
+    double totalSum = 0.0;
+    uint32_t totalCount = 0;
+
+    uint32_t lastSeq() const { return firstSeq + size - 1; }
+    Bucket& bucketAt(uint32_t seq) { return buckets[seq % RING_BUCKETS]; }
+    const Bucket& bucketAt(uint32_t seq) const { return buckets[seq % RING_BUCKETS]; }
+
+    void openBucket(unsigned long now) {
+        if (size == RING_BUCKETS) {
+            if (maxDeque.front() == firstSeq) maxDeque.popFront();
+            if (minDeque.front() == firstSeq) minDeque.popFront();
+            firstSeq++;
+            size--;
+        }
+        size++;
+        Bucket& bucket = bucketAt(lastSeq());
+        bucket.startMs = now;
+        bucket.min = FLT_MAX;
+        bucket.max = -FLT_MAX;
+        bucket.sumBefore = totalSum;
+        bucket.countBefore = totalCount;
+        maxDeque.pushBack(lastSeq());
+        minDeque.pushBack(lastSeq());
+    }
+};
+
+/**
+ * Sliding window statistics of every field produced by the sensors, answering queries
+ * like "max CO over the last 10 minutes" on the device.
+ * Memory is fixed: WINDOW_STATS_MAX_FIELDS windows of WINDOW_STATS_BUCKETS + 1 buckets each.
+ * Updated and queried from the sampling loop only.
+ */
+class WindowedStats {
+public:
+    /**
+     * Adds the values of a result. Fields beyond WINDOW_STATS_MAX_FIELDS are ignored.
+     */
+    void update(const SensorResult& result) {
+        unsigned long now = millis();
+        uint8_t entries = result.countEntries();
+        for (uint8_t i = 0; i < entries; i++) {
+            const char* key = result.getKey(i);
+            Field* field = find(result.getSensorName(), key);
+            if (field == nullptr) {
+                if (count >= WINDOW_STATS_MAX_FIELDS) continue;
+                field = &fields[count];
+                field->sensorName = result.getSensorName();
+                strncpy(field->key, key, SENSORENTRY_MAX_KEY_LEN - 1);
+                field->key[SENSORENTRY_MAX_KEY_LEN - 1] = '\0';
+                count++;
+            }
+            field->window.add(result.getValue(i), now);
+        }
+    }
+
+    /**
+     * Summarizes a field over the last windowMs milliseconds (at most WINDOW_STATS_SPAN_MS).
+     * @return false if the field is unknown or has no value in the window.
+     */
+    bool query(const char* sensorName, const char* key, unsigned long windowMs, FieldWindow::Summary& out) const {
+        const Field* field = find(sensorName, key);
+        return field != nullptr && field->window.query(windowMs, millis(), out);
+    }
+
+    /**
+     * Logs min/max/avg of every field over the last windowMs milliseconds.
+     */
+    void log(unsigned long windowMs) const {
+        FieldWindow::Summary summary;
+        for (size_t i = 0; i < count; i++) {
+            if (!fields[i].window.query(windowMs, millis(), summary)) continue;
+            Log.notice(F("%s.%s over %u s: min %F max %F avg %F (%u values)\n"), fields[i].sensorName, fields[i].key,
+                       static_cast<uint32_t>(windowMs / 1000), summary.min, summary.max, summary.avg, summary.count);
+        }
+    }
+
+private:
+    struct Field {
+        const char* sensorName;
+        char key[SENSORENTRY_MAX_KEY_LEN];
+        FieldWindow window;
+    };
+
+    Field fields[WINDOW_STATS_MAX_FIELDS];
+    size_t count = 0;
+
+    const Field* find(const char* sensorName, const char* key) const {
+        for (size_t i = 0; i < count; i++) {
+            if ((fields[i].sensorName == sensorName || strcmp(fields[i].sensorName, sensorName) == 0)
+                && strcmp(fields[i].key, key) == 0) {
+                return &fields[i];
+            }
+        }
+        return nullptr;
+    }
+
+    Field* find(const char* sensorName, const char* key) {
+        return const_cast<Field*>(static_cast<const WindowedStats*>(this)->find(sensorName, key));
+    }
+};
@@ -2,6 +2,9 @@
 
 #include <Arduino.h>
 #include "SensorManager.h"
+#include "InfluxLogger.h"
+#include "RulesEngine.h"
+#include "secrets.h"
 
 // --- Instructions ---
 // 1. Copy this template to 'config.h'.
@@ -14,6 +17,14 @@
 // This is required for managing all sensors in the system.
 extern SensorManager sensorManager;
 
+// Declare the global InfluxLogger instance.
+// Readings are encoded once and delivered to every sink registered on it.
+extern InfluxLogger influxLogger;
+
+// Declare the global RulesEngine instance.
+// Its rules are checked on every reading and emit events when they fire or clear.
+extern RulesEngine rulesEngine;
+
 // --- Sensor Includes and Instantiations ---
 // Include and instantiate only the sensors you want to use in your project.
 // Each sensor should have a unique name and, if needed, a configuration.
@@ -21,6 +32,17 @@ extern SensorManager sensorManager;
 // Example: Including and instantiating an MPU6050 sensor
 // #include <MPU6050Sensor.h>
 // MPU6050Sensor mpu6050_1 = MPU6050Sensor("MPU6050_1");
+// To detect motion through the MPU6050 INT pin instead of polling, pass the GPIO it is wired to:
+// MPU6050Sensor mpu6050_1 = MPU6050Sensor("MPU6050_1", 200, 4);
+// To fuse accelerometer and gyroscope on the device at the full loop rate and publish only
+// the orientation (quaternion, roll/pitch/yaw and tilt) every second:
+// MPU6050Sensor mpu6050_1 = MPU6050Sensor("MPU6050_1", 1000, -1, MPU6050Sensor::Output::ORIENTATION);
+// For machine monitoring, publish the vibration spectrum (band energies and dominant frequency) every 10 s:
+// MPU6050Sensor mpu6050_1 = MPU6050Sensor("MPU6050_1", 10000, -1, MPU6050Sensor::Output::SPECTRUM);
+// To read it through a shared I2C bus task, so the loop never waits on the bus (one I2cBus per
+// bus, passed to every sensor on it; its utilization and errors are logged periodically):
+// I2cBus i2cBus = I2cBus("I2C0", Wire, I2C_BUS_FREQUENCY);
+// MPU6050Sensor mpu6050_1 = MPU6050Sensor("MPU6050_1", 1000, -1, MPU6050Sensor::Output::ORIENTATION, &i2cBus);
 
 // Example: Including and instantiating an MQ-135 gas sensor
 // #include <MQ135Sensor.h>
@@ -34,19 +56,100 @@ extern SensorManager sensorManager;
 //     ANALOG_MIC_PIN // from settings.h
 // );
 
+// Example: Many analog inputs sampled by the shared continuous ADC1 scanner
+// (pins must be ADC1 pins: 32-39; no other sensor may then read ADC1 with analogRead())
+// #include <GenericAnalogInputSensor.h>
+// AdcScanner adcScanner;
+// GenericAnalogInputSensor analogInput1 = GenericAnalogInputSensor("Analog1", 32, 3.3f, 60000, &adcScanner);
+// GenericAnalogInputSensor analogInput2 = GenericAnalogInputSensor("Analog2", 33, 3.3f, 60000, &adcScanner);
+
+// Example: synthetic load for stress tests, 16 fields at 50 readings per second
+// #include <SyntheticSensor.h>
+// SyntheticSensor syntheticSensor = SyntheticSensor("Synthetic", 16, 50.0f);
+
 // Add additional sensors below as needed, following the examples above.
 
+// --- Sink Includes and Instantiations ---
+// Sinks are the destinations of the logged data. Enable at least one.
+// Each sink has its own queue, so a slow or unreachable one does not delay the others.
+
+// Example: InfluxDB v2 HTTP write API
+// #include <InfluxHttpSink.h>
+// InfluxHttpSink influxSink = InfluxHttpSink(SECRET_INFLUXDB_HOST, SECRET_INFLUXDB_ORG, SECRET_INFLUXDB_BUCKET, SECRET_INFLUXDB_TOKEN);
+
+// Example: benchmark against tools/mock_influxdb.py running on a computer of the LAN
+// InfluxHttpSink influxSink = InfluxHttpSink("http://192.168.1.20:8086", "org", "bucket", "token");
+
+// Example: MQTT broker (e.g. a local mosquitto), one line protocol message per batch
+// #include <MqttSink.h>
+// MqttSink mqttSink = MqttSink("192.168.1.10", 1883, "openmonitor/D0", "openmonitor-D0", SECRET_MQTT_USER, SECRET_MQTT_PASSWORD);
+
+// Example: UDP collector (e.g. Telegraf socket_listener)
+// #include <UdpSink.h>
+// UdpSink udpSink = UdpSink("192.168.1.10", 8094);
+
+// Example: raw line protocol on the serial port
+// #include <SerialSink.h>
+// SerialSink serialSink = SerialSink(Serial);
+
+// Example: keep the encoded batches in memory, to measure the sustainable points per second
+// together with a SyntheticSensor (the argument emulates the latency of each send, in ms)
+// #include <RecordingSink.h>
+// RecordingSink recordingSink = RecordingSink(50);
+
+// With INFLUX_STREAM_UPLOAD in settings.h, each upload burst streams the whole reading
+// buffer to InfluxDB in one chunked request instead of sending batches to the sinks
+// (which then only get the alarms). Required by that setting.
+// #include <InfluxHttpStream.h>
+// InfluxHttpStream influxStream(SECRET_INFLUXDB_HOST, SECRET_INFLUXDB_ORG, SECRET_INFLUXDB_BUCKET, SECRET_INFLUXDB_TOKEN);
+
+void addSinksToLogger() {
+    // influxLogger.addSink(&influxSink);
+    // influxLogger.addSink(&mqttSink);
+    // influxLogger.addSink(&recordingSink);
+}
+
+// --- Add Rules to the Engine ---
+// Each rule watches one field of one sensor, identified by the names used above.
+// Events are logged as a measurement named after the rule, and sent immediately.
+
+void addRulesToEngine() {
+    // Example: CO above 35 ppm, cleared once it is back below 30 ppm
+    // rulesEngine.addRule(Rule::above("co_high", "MQ-135", "CO", 35.0f, 5.0f));
+
+    // Example: CO2 rising faster than 50 ppm per second
+    // rulesEngine.addRule(Rule::rateAbove("co2_rise", "MQ-135", "CO2", 50.0f, 10.0f));
+
+    // Example: noise level above 85 dB
+    // rulesEngine.addRule(Rule::above("loud", "AnalogMic1", "mean_dBSPL", 85.0f, 3.0f));
+}
+
 // --- Add Sensors to the Manager ---
 // Register each sensor with the SensorManager inside this function.
 // The parameters 'throwOnInitializationError' and 'throwOnUpdateError' control
-// whether exceptions are thrown on initialization or update failures.
-// Adjust these flags based on the criticality of each sensor.
+// whether exceptions are thrown on initialization failures, and when a sensor is updated
+// or read before it was initialized. Adjust these flags based on the criticality of each sensor.
+// Failed hardware reads (e.g. an I2C error) never propagate from SensorManager: they are
+// logged, and after SENSOR_QUARANTINE_FAILURES in a row the sensor is quarantined and
+// probed again with a backoff until it recovers.
+
+// --- Compile-time Sensor Set (optional) ---
+// When the sensor set never changes at runtime, StaticSensorManager visits the sensors
+// without virtual calls or a sensor vector. It can replace SensorManager in main.cpp:
+// #include "StaticSensorManager.h"
+// StaticSensorManager<MPU6050Sensor, MQ135Sensor> staticSensors(mpu6050_1, mq135Sensor);
+// With STATIC_SENSOR_MANAGER_BENCHMARK, add the same sensors to sensorManager as well:
+// setup() compares the cycles per loop of both managers.
 
 void addSensorsToManager() {
     // Example of adding sensors to the manager:
     // sensorManager.addSensor(&mpu6050_1, true, true);
     // sensorManager.addSensor(&mq135Sensor, true, true);
 
+    // Example of a dependency: the MQ-135 is compensated with the MPU6050 temperature,
+    // which is read first in each tick and reused without another hardware read:
+    // sensorManager.addDependency(&mq135Sensor, &mpu6050_1);
+
     // Example of adding a generic analog input sensor:
     // sensorManager.addSensor(&analogInput1, true, true);
 
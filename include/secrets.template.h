@@ -11,6 +11,9 @@
 #define SECRET_INFLUXDB_ORG ""
 #define SECRET_INFLUXDB_TOKEN ""
 
+#define SECRET_MQTT_USER ""
+#define SECRET_MQTT_PASSWORD ""
+
 #define SECRET_WIFI_SSID ""
 #define SECRET_WIFI_PASSWORD ""
 
@@ -17,17 +17,171 @@
 // Maximum key length for sensor entries.
 #define SENSORENTRY_MAX_KEY_LEN 8
 
+// --- Sensor Health Settings ---
+// A sensor failing or too slow repeatedly is quarantined: it is no longer updated or read,
+// only probed with a forced read, with exponential backoff, until a probe succeeds in time.
+#define SENSOR_QUARANTINE_FAILURES 3 // consecutive failed reads
+#define SENSOR_QUARANTINE_SLOW_READS 3 // consecutive reads over the time budget
+#define SENSOR_READ_BUDGET_US 20000UL // default time budget of a read, see ISensor::readTimeBudgetUs()
+#define SENSOR_PROBE_BACKOFF_MIN_MS 1000UL // Delay before the first probe, doubled after each failed probe, with jitter
+#define SENSOR_PROBE_BACKOFF_MAX_MS 300000UL
+
 // --- Error Message Settings ---
 // Maximum length for error messages.
 #define MAX_ERROR_MESSAGE_LEN 128
 
 // --- Logging Interval ---
-// Interval for logging data in milliseconds.
+// Interval for logging sensor values to the console in milliseconds.
+// Also the initial flush interval, later tuned by the adaptive batching.
 #define LOG_INTERVAL 5000 // 5 seconds
 
+// --- Asynchronous Logging Settings ---
+// Log lines are queued in RAM and written to Serial by a background task, so logging
+// never blocks the sampling loop. When the buffer is full, lines are dropped and counted.
+#define ASYNC_LOG_ENABLED 1
+#define ASYNC_LOG_BUFFER_SIZE 8192 // bytes, power of two
+#define ASYNC_LOG_TASK_STACK 2048
+#define ASYNC_LOG_TASK_PRIORITY 1
+#define ASYNC_LOG_DRAIN_INTERVAL_MS 10
+#define ASYNC_LOG_STAGES 4 // Tasks that can build a line at the same time, 128 bytes each
+
+// --- Reading Buffer Settings ---
+// Size in bytes of the local buffer holding readings until they are uploaded.
+// When full, the oldest readings are dropped.
+#define READING_BUFFER_SIZE 32768
+
+// --- Log Sink Settings ---
+// Every sink has its own queue of encoded batches and its own task.
+#define LOG_SINK_QUEUE_DEPTH 8 // batches, the oldest is dropped when full
+#define LOG_SINK_TASK_STACK 4096
+#define LOG_SINK_TASK_PRIORITY 1
+#define LOG_SINK_POLL_INTERVAL_MS 100
+#define LOG_SINK_BACKOFF_MIN_MS 1000UL // Retry delay after the first failure, doubled on each failure, with jitter
+#define LOG_SINK_BACKOFF_MAX_MS 60000UL
+#define LOG_SINK_URGENT_BACKOFF_MAX_MS 10000UL // Alarms are retried more often than regular batches
+#define LOG_SINK_DRAIN_TIMEOUT 10000UL // ms to wait for network sinks before turning the radio off
+#define LOG_SINK_URGENT_QUEUE_DEPTH 4 // alarm readings, sent ahead of the regular batches
+#define INFLUX_SINK_TASK_STACK 8192 // TLS needs a larger stack
+#define HTTP_CONNECT_TIMEOUT_MS 10000UL // TCP connect and TLS handshake
+#define HTTP_IDLE_TIMEOUT_MS 30000UL // Kept-alive connections unused this long are closed
+#define UDP_SINK_MAX_DATAGRAM 1400 // bytes
+#define LINE_PROTOCOL_DECIMALS 2 // Decimals used for field values
+// Upload bursts stream the whole reading buffer to InfluxDB in one chunked request (InfluxHttpStream)
+#define INFLUX_STREAM_UPLOAD 0
+#define INFLUX_STREAM_CHUNK_SIZE 1024 // bytes, the only buffer the stream needs
+#define INFLUX_STREAM_MAX_POINTS 0 // per request, 0 for the whole buffer
+#define INFLUX_STREAM_TIMEOUT_MS 10000UL // to wait for the response
+
+// --- Rules Engine Settings ---
+// Rules are evaluated on every sensor result; see addRulesToEngine() in config.h.
+#define RULES_ENGINE_MAX_RULES 16 // at most 32
+
+// --- Windowed Statistics Settings ---
+// Recent min/max/avg of each field, kept on the device for windows up to WINDOW_STATS_SPAN_MS.
+// Each field uses about 32 bytes per bucket; the bucket length is SPAN / BUCKETS.
+#define WINDOW_STATS_MAX_FIELDS 16 // Fields beyond this are not tracked
+#define WINDOW_STATS_BUCKETS 60
+#define WINDOW_STATS_SPAN_MS 600000UL // 10 minutes, in 10 s buckets
+#define WINDOW_STATS_LOG_WINDOW_MS 60000UL // Window logged with the sensor values, 0 to disable
+
+// --- Metrics Server Settings ---
+// HTTP endpoint serving the latest readings (/metrics for Prometheus, /json).
+// Only reachable while the radio is on, so it is not useful together with RADIO_DUTY_CYCLE_ENABLED.
+#define METRICS_SERVER_ENABLED 0
+#define METRICS_SERVER_PORT 80
+#define METRICS_SERVER_TASK_STACK 6144
+#define METRICS_SERVER_TASK_PRIORITY 1
+#define METRICS_SERVER_POLL_INTERVAL_MS 10
+#define READINGS_SNAPSHOT_MAX_FIELDS 64 // Fields beyond this are not exposed
+
+// --- Adaptive Batching Settings ---
+// Batch size and flush interval are tuned at runtime from the latency and failures of the sends,
+// separately for each network sink; flushes follow the sink that is doing best.
+// The flush interval starts at LOG_INTERVAL.
+#define ADAPTIVE_BATCH_INITIAL_POINTS 100
+#define ADAPTIVE_BATCH_MIN_POINTS 20
+#define ADAPTIVE_BATCH_MAX_POINTS 500 // Bounds the RAM used by one encoded batch
+#define ADAPTIVE_BATCH_STEP_POINTS 20 // Growth after each fast send
+#define ADAPTIVE_FLUSH_INTERVAL_MIN_MS 2000UL
+#define ADAPTIVE_FLUSH_INTERVAL_MAX_MS 60000UL
+#define ADAPTIVE_TARGET_LATENCY_MS 1500UL // Sends slower than this shrink the batches
+
+// --- Radio Duty Cycle Settings ---
+// When enabled, WiFi is turned off between uploads and readings are sent in bursts
+// every RADIO_WAKE_INTERVAL, or earlier once RADIO_WAKE_BUFFER_THRESHOLD readings are buffered.
+#define RADIO_DUTY_CYCLE_ENABLED 0
+#define RADIO_WAKE_INTERVAL 300000UL // 5 minutes
+#define RADIO_WAKE_BUFFER_THRESHOLD 400 // readings
+#define RADIO_CONNECT_TIMEOUT 15000UL // ms
+#define RADIO_ALARM_RETRY_MIN_MS 30000UL // After a failed alarm wake, doubled on each failure up to RADIO_WAKE_INTERVAL
+
+// --- Light Sleep Settings ---
+// Sleep between sensor deadlines instead of spinning in loop().
+// WiFi association is not kept during light sleep, it is re-established before each upload.
+// Works best together with RADIO_DUTY_CYCLE_ENABLED.
+#define LIGHT_SLEEP_ENABLED 0
+#define LIGHT_SLEEP_MIN_MS 20UL // Shorter idle periods are spent awake
+
+// --- ADC Scanner Settings ---
+// Shared continuous ADC1 scan used by GenericAnalogInputSensor instances given an AdcScanner.
+// It cannot run together with sensors reading ADC1 pins with analogRead() (MQ135Sensor,
+// AnalogMicrophoneSensor, GenericAnalogInputSensor without a scanner); their begin() fails
+// if a scan is running, and the scan fails to start after them.
+#define ADC_SCAN_SAMPLE_FREQ_HZ 20000 // Total conversions per second, shared by all channels
+#define ADC_SCAN_OVERSAMPLE 64 // Samples averaged per channel for each published value
+#define ADC_SCAN_FRAME_BYTES 256 // DMA frame size
+#define ADC_SCAN_DEFAULT_VREF_MV 1100 // Used only if the eFuse holds no calibration
+#define ADC_SCAN_TASK_STACK 3072
+#define ADC_SCAN_TASK_PRIORITY 2
+
+// --- I2C Bus Settings ---
+// Shared I2C bus used by the drivers given an I2cBus (e.g. MPU6050Sensor).
+#define I2C_BUS_FREQUENCY 400000 // Hz; 1000000 only if every device supports Fast-mode Plus
+#define I2C_BUS_QUEUE_DEPTH 16 // Transactions (or batches) waiting for the bus
+#define I2C_BUS_TIMEOUT_MS 10 // Per transaction, a stuck device fails instead of blocking the bus
+#define I2C_BUS_TASK_STACK 3072
+#define I2C_BUS_TASK_PRIORITY 3 // Above the sinks, so the sampling is not delayed by uploads
+
 // --- Analog Microphone Sensor Settings ---
 #define VREF_VALUE 3.3f
 #define ANALOG_MIC_GAIN 75.0f
 #define ANALOG_MIC_SAMPLING_DURATION 50UL // ms
+#define ANALOG_MIC_BLOCK_SIZE 32 // samples reduced together
+
+// --- Static Sensor Manager Settings ---
+// Times SensorManager against StaticSensorManager over the same sensors at startup.
+// Needs a StaticSensorManager named staticSensors in config.h, see config.template.h.
+#define STATIC_SENSOR_MANAGER_BENCHMARK 0
+#define STATIC_SENSOR_MANAGER_BENCHMARK_LOOPS 1000
+
+// --- Block Statistics Settings ---
+// Times the sample reduction kernels at startup, and checks them against the scalar reference.
+#define BLOCK_STATS_BENCHMARK 0
+
+// --- MPU6050 Motion Interrupt Settings ---
+// Used only when the sensor is constructed with an interrupt pin.
+#define MPU6050_MOTION_THRESHOLD 5 // 1 LSB = 2 mg
+#define MPU6050_MOTION_DURATION 20 // ms above threshold before INT is raised
+#define MPU6050_MOTION_EVENT_GAP_MS 250UL // Motion is considered over after this long without interrupts
+
+// --- MPU6050 Orientation Fusion Settings ---
+// Used only when the sensor is constructed with Output::ORIENTATION.
+#define MPU6050_FUSION_BETA 0.1f // Madgwick gain: higher converges faster, lower rejects vibration better
+
+// --- MPU6050 Vibration Spectrum Settings ---
+// Used only when the sensor is constructed with Output::SPECTRUM.
+// Each read blocks while the window is captured: VIBRATION_FFT_SIZE / VIBRATION_SAMPLE_RATE_HZ seconds.
+// Above about 500 Hz a 100 kHz I2C bus cannot keep up: run it at 400 kHz (Wire.setClock(400000)
+// in setup(), or I2C_BUS_FREQUENCY with an I2cBus), if every device on the bus supports it.
+#define VIBRATION_FFT_SIZE 256 // samples per window, power of two
+#define VIBRATION_SAMPLE_RATE_HZ 800 // at most 1000, the accelerometer output rate
+#define VIBRATION_BAND_EDGES_HZ {2.0f, 10.0f, 50.0f, 100.0f, 200.0f, 400.0f} // up to 11 edges, up to half the sample rate
+
+// --- MQ135 Settings ---
+#define MQ135_SERIAL_DEBUG 0 // Library debug table on every read, written directly to Serial
+
+// --- MQ135 Alarm Settings ---
+// Readings at or above this CO level skip batching and are sent immediately.
+#define MQ135_CO_ALARM_PPM 50.0f
 
 #endif
\ No newline at end of file
@@ -0,0 +1,201 @@
+#include "AdcScanner.h"
+#include <ArduinoLog.h>
+#include "../../include/SensorExceptions.h"
+
+uint8_t AdcScanner::directChannels = 0;
+uint8_t AdcScanner::runningScans = 0;
+
+AdcScanner::~AdcScanner() {
+    stopDriver();
+    delete[] calibrationLut;
+}
+
+void AdcScanner::addPin(uint8_t pin) {
+    int8_t channel = channelForPin(pin);
+    if (channel < 0) {
+        throw SensorInitializationException("Pin is not an ADC1 pin, cannot be scanned");
+    }
+    if (channelMask & (1 << channel)) {
+        return;
+    }
+
+    bool wasRunning = running;
+    if (wasRunning) stopDriver();
+    channelMask |= (1 << channel);
+    Log.notice(F("[AdcScanner] Pin %d added on ADC1 channel %d" CR), pin, channel);
+    if (wasRunning) startDriver();
+}
+
+void AdcScanner::begin() {
+    if (running) {
+        return;
+    }
+    if (calibrationLut == nullptr) {
+        buildCalibrationLut();
+    }
+    startDriver();
+}
+
+void AdcScanner::claimDirectRead(uint8_t pin) {
+    int8_t channel = channelForPin(pin);
+    if (channel < 0) {
+        return;
+    }
+    if (runningScans > 0) {
+        Log.error(F("[AdcScanner] Pin %d is on ADC1, which the scan owns: read it through the scanner" CR), pin);
+        throw SensorInitializationException("ADC1 pin cannot be read with analogRead() while the scan runs");
+    }
+    directChannels |= (1 << channel);
+}
+
+bool AdcScanner::hasValue(uint8_t pin) const {
+    int8_t channel = channelForPin(pin);
+    return channel >= 0 && channels[channel].valid.load(std::memory_order_acquire);
+}
+
+bool AdcScanner::latest(uint8_t pin, uint16_t& raw, uint32_t& millivolts) const {
+    if (!hasValue(pin)) {
+        return false;
+    }
+    uint32_t average = channels[channelForPin(pin)].average.load(std::memory_order_relaxed);
+    raw = average & 0xFFFF;
+    millivolts = average >> 16;
+    return true;
+}
+
+/**
+ * Precomputes the raw to mV conversion for every code, so the scan task
+ * converts each sample with a table lookup instead of the calibration curve.
+ */
+void AdcScanner::buildCalibrationLut() {
+    esp_adc_cal_characteristics_t characteristics;
+    esp_adc_cal_value_t source = esp_adc_cal_characterize(ADC_UNIT_1, ADC_ATTEN_DB_11, ADC_WIDTH_BIT_12,
+                                                          ADC_SCAN_DEFAULT_VREF_MV, &characteristics);
+    calibrationLut = new uint16_t[ADC_MAX_RAW + 1];
+    for (uint32_t raw = 0; raw <= ADC_MAX_RAW; raw++) {
+        calibrationLut[raw] = esp_adc_cal_raw_to_voltage(raw, &characteristics);
+    }
+    Log.notice(F("[AdcScanner] Calibration table built from %s" CR),
+               source == ESP_ADC_CAL_VAL_EFUSE_TP ? "eFuse two point" :
+               source == ESP_ADC_CAL_VAL_EFUSE_VREF ? "eFuse Vref" : "default Vref");
+}
+
+void AdcScanner::startDriver() {
+    if (channelMask == 0) {
+        return;
+    }
+    if (directChannels != 0) {
+        Log.error(F("[AdcScanner] ADC1 channels 0x%x are read with analogRead(), the scan would break them" CR),
+                  directChannels);
+        throw SensorInitializationException("ADC1 pins are read with analogRead(), cannot start the scan");
+    }
+
+    adc_digi_init_config_t initConfig = {};
+    initConfig.max_store_buf_size = ADC_SCAN_FRAME_BYTES * 4;
+    initConfig.conv_num_each_intr = ADC_SCAN_FRAME_BYTES;
+    initConfig.adc1_chan_mask = channelMask;
+    initConfig.adc2_chan_mask = 0;
+    if (adc_digi_initialize(&initConfig) != ESP_OK) {
+        throw SensorInitializationException("ADC continuous driver initialization failed");
+    }
+
+    adc_digi_pattern_config_t pattern[ADC1_CHANNELS] = {};
+    uint8_t patternCount = 0;
+    for (uint8_t channel = 0; channel < ADC1_CHANNELS; channel++) {
+        if (!(channelMask & (1 << channel))) continue;
+        pattern[patternCount].atten = ADC_ATTEN_DB_11;
+        pattern[patternCount].channel = channel;
+        pattern[patternCount].unit = 0; // ADC1
+        pattern[patternCount].bit_width = SOC_ADC_DIGI_MAX_BITWIDTH;
+        patternCount++;
+    }
+
+    adc_digi_configuration_t config = {};
+    config.conv_limit_en = true;
+    config.conv_limit_num = 250;
+    config.pattern_num = patternCount;
+    config.adc_pattern = pattern;
+    config.sample_freq_hz = ADC_SCAN_SAMPLE_FREQ_HZ;
+    config.conv_mode = ADC_CONV_SINGLE_UNIT_1;
+    config.format = ADC_DIGI_OUTPUT_FORMAT_TYPE1;
+    if (adc_digi_controller_configure(&config) != ESP_OK) {
+        adc_digi_deinitialize();
+        throw SensorInitializationException("ADC continuous driver configuration failed");
+    }
+
+    running = true;
+    runningScans++;
+    adc_digi_start();
+    xTaskCreate(taskEntry, "AdcScanner", ADC_SCAN_TASK_STACK, this, ADC_SCAN_TASK_PRIORITY, &task);
+    Log.notice(F("[AdcScanner] Scanning %d channels at %u Hz" CR), patternCount, ADC_SCAN_SAMPLE_FREQ_HZ);
+}
+
+void AdcScanner::stopDriver() {
+    if (!running) {
+        return;
+    }
+    // The task may be in the middle of a read on the other core: it exits on its own
+    // before the driver and its buffers go away
+    stopWaiter = xTaskGetCurrentTaskHandle();
+    running = false;
+    runningScans--;
+    if (task) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        task = nullptr;
+    }
+    stopWaiter = nullptr;
+    adc_digi_stop();
+    adc_digi_deinitialize();
+    for (Channel& channel : channels) {
+        channel.sumRaw = 0;
+        channel.sumMillivolts = 0;
+        channel.samples = 0;
+    }
+}
+
+void AdcScanner::processFrame(const uint8_t* data, uint32_t length) {
+    const adc_digi_output_data_t* samples = reinterpret_cast<const adc_digi_output_data_t*>(data);
+    uint32_t count = length / sizeof(adc_digi_output_data_t);
+
+    for (uint32_t i = 0; i < count; i++) {
+        uint8_t channelIdx = samples[i].type1.channel;
+        uint16_t raw = samples[i].type1.data;
+        if (channelIdx >= ADC1_CHANNELS || raw > ADC_MAX_RAW) continue;
+
+        Channel& channel = channels[channelIdx];
+        channel.sumRaw += raw;
+        channel.sumMillivolts += calibrationLut[raw];
+        if (++channel.samples < ADC_SCAN_OVERSAMPLE) continue;
+
+        // One store, so readers never pair a raw value with the voltage of another window
+        uint32_t millivolts = channel.sumMillivolts / channel.samples;
+        channel.average.store(millivolts << 16 | channel.sumRaw / channel.samples, std::memory_order_relaxed);
+        channel.valid.store(true, std::memory_order_release);
+        channel.sumRaw = 0;
+        channel.sumMillivolts = 0;
+        channel.samples = 0;
+    }
+}
+
+int8_t AdcScanner::channelForPin(uint8_t pin) {
+    int8_t channel = digitalPinToAnalogChannel(pin);
+    return (channel >= 0 && channel < ADC1_CHANNELS) ? channel : -1;
+}
+
+void AdcScanner::taskEntry(void* arg) {
+    AdcScanner* scanner = static_cast<AdcScanner*>(arg);
+    uint8_t frame[ADC_SCAN_FRAME_BYTES];
+    while (scanner->running) {
+        uint32_t length = 0;
+        esp_err_t err = adc_digi_read_bytes(frame, sizeof(frame), &length, READ_TIMEOUT_MS);
+        if (err == ESP_ERR_INVALID_STATE) {
+            // The DMA pool overflowed, the samples read are still valid
+            scanner->overflows.fetch_add(1, std::memory_order_relaxed);
+        } else if (err != ESP_OK) {
+            continue;
+        }
+        scanner->processFrame(frame, length);
+    }
+    xTaskNotifyGive(scanner->stopWaiter);
+    vTaskDelete(nullptr);
+}
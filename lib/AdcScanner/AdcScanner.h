@@ -0,0 +1,96 @@
+#pragma once
+
+#include <Arduino.h>
+#include <atomic>
+#include <driver/adc.h>
+#include <esp_adc_cal.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include "settings.h"
+
+/**
+ * @brief Shared ADC1 scan engine for many analog inputs.
+ * All registered pins are sampled in continuous (DMA) mode by the hardware; a task
+ * oversamples and averages each channel and converts it with the eFuse calibration
+ * through a precomputed lookup table. Readers only fetch the latest average, which
+ * never blocks.
+ * While the scanner runs, ADC1 pins must not be read with analogRead(): sensors that do
+ * register their pin with claimDirectRead(), and the scan and the direct reads refuse to
+ * start together.
+ */
+class AdcScanner {
+public:
+    AdcScanner() = default;
+    ~AdcScanner();
+
+    AdcScanner(const AdcScanner&) = delete;
+    AdcScanner& operator=(const AdcScanner&) = delete;
+
+    /**
+     * Adds a pin to the scan. If the scan is already running it is restarted: the scan
+     * task is stopped first, then the driver.
+     * @throws SensorInitializationException if the pin is not an ADC1 pin or too many pins are registered.
+     */
+    void addPin(uint8_t pin);
+
+    /**
+     * Starts the continuous scan. Does nothing if already running.
+     * @throws SensorInitializationException if the ADC driver cannot be started or an ADC1
+     * pin is read with analogRead() (see claimDirectRead()).
+     */
+    void begin();
+
+    /**
+     * Registers a pin read with analogRead(). The continuous driver takes ADC1 over, so
+     * such reads and a scan exclude each other; ADC2 pins are not affected.
+     * @throws SensorInitializationException if the pin is an ADC1 pin and a scan is running.
+     */
+    static void claimDirectRead(uint8_t pin);
+
+    /**
+     * @return true if at least one averaged value is available for the pin.
+     */
+    bool hasValue(uint8_t pin) const;
+
+    /**
+     * Latest averaged raw value (0-4095) and calibrated voltage (mV) of the pin, both from
+     * the same averaging window.
+     * @return false if no averaged value is available yet.
+     */
+    bool latest(uint8_t pin, uint16_t& raw, uint32_t& millivolts) const;
+
+    uint32_t droppedFrames() const { return overflows.load(std::memory_order_relaxed); }
+
+private:
+    static constexpr uint8_t ADC1_CHANNELS = 8;
+    static constexpr uint16_t ADC_MAX_RAW = 4095;
+    static constexpr uint32_t READ_TIMEOUT_MS = 20; // How soon the scan task notices a stop
+
+    struct Channel {
+        std::atomic<uint32_t> average{0}; // Raw value in the low half, mV in the high half
+        std::atomic<bool> valid{false};
+        // Accumulators, only touched by the scan task
+        uint32_t sumRaw = 0;
+        uint32_t sumMillivolts = 0;
+        uint32_t samples = 0;
+    };
+
+    Channel channels[ADC1_CHANNELS];
+    uint8_t channelMask = 0;
+    uint16_t* calibrationLut = nullptr; // raw -> mV
+    TaskHandle_t task = nullptr;
+    TaskHandle_t volatile stopWaiter = nullptr; // Notified by the scan task once it stopped reading
+    volatile bool running = false;
+    std::atomic<uint32_t> overflows{0};
+
+    // ADC1 channels read with analogRead() and scans running, shared by all instances
+    static uint8_t directChannels;
+    static uint8_t runningScans;
+
+    void buildCalibrationLut();
+    void startDriver();
+    void stopDriver();
+    void processFrame(const uint8_t* data, uint32_t length);
+    static int8_t channelForPin(uint8_t pin);
+    static void taskEntry(void* arg);
+};
@@ -2,6 +2,13 @@
 #include <ArduinoLog.h>
 #include <math.h>
 #include "../../include/SensorExceptions.h"
+#include "AdcScanner.h"
+
+// Sound levels only need 0.1 dB resolution while buffered
+static constexpr FieldSchema FIELD_SCHEMA[] = {
+    {"mean_dBSPL", 0.1f, 0.0f},
+    {"peak_dBSPL", 0.1f, 0.0f},
+};
 
 // Microphone sensitivity: -44 dBV/Pa = 6.31 mV/Pa
 constexpr float MIC_SENSITIVITY_V_PER_PA = 0.00631f;
@@ -9,6 +16,7 @@ constexpr float DB_SPL_REF = 94.0f; // Reference SPL for sensitivity
 constexpr int ADC_RESOLUTION = 4095; // 12-bit ADC for ESP32
 
 void AnalogMicrophoneSensor::begin() {
+    AdcScanner::claimDirectRead(analogPin);
     isInitialized = true;
     resetSamplingState();
     Log.notice(F("[AnalogMicrophone] Sensor initialized on pin %d" CR), analogPin);
@@ -63,37 +71,42 @@ SensorResult AnalogMicrophoneSensor::readValues(bool force, bool updateReadTime)
 }
 
 void AnalogMicrophoneSensor::resetSamplingState() {
-    signalMax = 0;
-    signalMin = ADC_RESOLUTION;
-    sumVrms = 0.0f;
-    peakVrms = 0.0f;
-    sampleCount = 0;
+    levels.reset();
+    blockLength = 0;
 }
 
 void AnalogMicrophoneSensor::processSample() {
     unsigned int sample = analogRead(analogPin);
     if (sample <= ADC_RESOLUTION) {
-        if (sample > signalMax) signalMax = sample;
-        if (sample < signalMin) signalMin = sample;
-        float v = (static_cast<float>(sample) / ADC_RESOLUTION) * VREF_VALUE;
-        float vBias = VREF_VALUE / 2.0f;
-        float vAc = v - vBias;
-        float vrmsSample = fabsf(vAc);
-        sumVrms += vrmsSample;
-        if (vrmsSample > peakVrms) peakVrms = vrmsSample;
-        ++sampleCount;
+        block[blockLength++] = sample;
+        if (blockLength == ANALOG_MIC_BLOCK_SIZE) {
+            flushBlock();
+        }
     }
 }
 
+void AnalogMicrophoneSensor::flushBlock() {
+    levels.add(block, blockLength);
+    blockLength = 0;
+}
+
 void AnalogMicrophoneSensor::computeResults() {
-    peakToPeak = signalMax - signalMin;
+    flushBlock();
+    peakToPeak = static_cast<unsigned int>(levels.peakToPeak());
     float vref = MIC_SENSITIVITY_V_PER_PA * ANALOG_MIC_GAIN;
     
-    // Calculate mean and peak dB SPL
-    float meanVrms = (sampleCount > 0) ? (sumVrms / sampleCount) : 0.0f;
+    // Deviations from the bias, in V
+    constexpr float voltsPerCode = VREF_VALUE / ADC_RESOLUTION;
+    float meanVrms = levels.absMean() * voltsPerCode;
+    float peakVrms = levels.absPeak() * voltsPerCode;
     mean_dBSPL = (meanVrms > 0.0f) ? (20.0f * log10f(meanVrms / vref) + DB_SPL_REF) : 0.0f;
     peak_dBSPL = (peakVrms > 0.0f) ? (20.0f * log10f(peakVrms / vref) + DB_SPL_REF) : 0.0f;
     
     Log.verboseln(F("[AnalogMicrophone][computeResults] Samples: %d, peakToPeak: %d, mean dB SPL: %F, peak dB SPL: %F"), 
-                  sampleCount, peakToPeak, mean_dBSPL, peak_dBSPL);
+                  levels.count(), peakToPeak, mean_dBSPL, peak_dBSPL);
+}
+
+const FieldSchema* AnalogMicrophoneSensor::getFieldSchema(uint8_t& count) const {
+    count = sizeof(FIELD_SCHEMA) / sizeof(FIELD_SCHEMA[0]);
+    return FIELD_SCHEMA;
 }
@@ -4,10 +4,12 @@
 #include "../../include/ISensor.h"
 #include "../../include/ResultCode.h"
 #include "../SensorResult/SensorResult.h"
+#include "BlockStats.h"
 
 /**
  * @brief Analog microphone sensor (e.g. MAX4466) for sound level measurement in dB SPL.
  * Samples the analog input asynchronously, computes peak-to-peak amplitude, and estimates dB SPL.
+ * Samples are collected in blocks of ANALOG_MIC_BLOCK_SIZE and reduced a block at a time.
  */
 class AnalogMicrophoneSensor : public ISensor {
 public:
@@ -25,6 +27,8 @@ public:
     void begin() override;
     void update() override;
     SensorResult readValues(bool force = false, bool updateReadTime = true) override;
+    const FieldSchema* getFieldSchema(uint8_t& count) const override;
+    bool requiresContinuousSampling() const override { return isSampling; }
 
 private:
     uint8_t analogPin;
@@ -34,12 +38,11 @@ private:
     unsigned long samplingStartTime = 0;
     bool isSampling = false;
     
-    // Sampling accumulators
-    unsigned int signalMax = 0;
-    unsigned int signalMin = 4095; // 12-bit ADC for ESP32
-    float sumVrms = 0.0f;
-    float peakVrms = 0.0f;
-    unsigned int sampleCount = 0;
+    // Sampling accumulators; the absolute deviation is taken from mid-scale (the bias)
+    static constexpr uint16_t ADC_MAX = 4095; // 12-bit ADC for ESP32
+    uint16_t block[ANALOG_MIC_BLOCK_SIZE];
+    uint16_t blockLength = 0;
+    BlockStats levels{ADC_MAX / 2.0f};
 
     // Last computed values
     unsigned int peakToPeak = 0;
@@ -48,5 +51,6 @@ private:
     
     void resetSamplingState();
     void processSample();
+    void flushBlock();
     void computeResults();
 };
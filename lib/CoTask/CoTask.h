@@ -0,0 +1,87 @@
+#pragma once
+
+#include <Arduino.h>
+
+/**
+ * @brief Cooperative task written sequentially, in the style of protothreads.
+ * The body, run(), is resumed by its owner (e.g. from ISensor::update() on every loop)
+ * and returns to it wherever it has to wait, instead of blocking the loop; the next
+ * resume() continues right after the wait. Waits are written with the CO_* macros:
+ *
+ *   void run() override {
+ *       CO_BEGIN();
+ *       for (index = 0; index < 10; index++) {
+ *           CO_AWAIT(transferDone);
+ *           CO_SLEEP_MS(2);
+ *       }
+ *       CO_END();
+ *   }
+ *
+ * The body is a switch in disguise: locals do not survive a wait, so the state lives in
+ * members; a wait cannot sit inside a nested switch, and there is at most one per line.
+ * The ESP32 toolchain (GCC 8) has no C++20 coroutines, hence the macros.
+ */
+class CoTask {
+public:
+    virtual ~CoTask() = default;
+
+    /**
+     * Runs the body from the beginning on the next resume(), even if it was running.
+     */
+    void start() {
+        resumePoint = 0;
+        sleeping = false;
+        running = true;
+    }
+
+    void cancel() { running = false; }
+
+    /**
+     * Runs the body until its next wait or its end. Returns immediately while sleeping.
+     * @return true while the task is running.
+     */
+    bool resume() {
+        if (!running) return false;
+        if (sleeping && static_cast<long>(millis() - wakeAt) < 0) return true;
+        sleeping = false;
+        run();
+        return running;
+    }
+
+    bool isRunning() const { return running; }
+
+    /**
+     * @return Time left in the current CO_SLEEP_MS(), 0 if the task is not sleeping.
+     */
+    unsigned long millisUntilWake() const {
+        if (!running || !sleeping) return 0;
+        long remaining = static_cast<long>(wakeAt - millis());
+        return remaining > 0 ? remaining : 0;
+    }
+
+protected:
+    /**
+     * The body, between CO_BEGIN() and CO_END().
+     */
+    virtual void run() = 0;
+
+    uint16_t resumePoint = 0; // Line of the wait to continue from, 0 at the beginning
+    bool running = false;
+    bool sleeping = false;
+    unsigned long wakeAt = 0;
+};
+
+#define CO_BEGIN() switch (resumePoint) { case 0:
+
+#define CO_END() } running = false; resumePoint = 0
+
+// Leaves the body, which is then done
+#define CO_EXIT() do { running = false; resumePoint = 0; return; } while (0)
+
+// Gives the loop a turn, continues on the next resume()
+#define CO_YIELD() do { resumePoint = __LINE__; return; case __LINE__:; } while (0)
+
+// Continues once condition holds; it is checked on every resume()
+#define CO_AWAIT(condition) do { resumePoint = __LINE__; [[fallthrough]]; case __LINE__: if (!(condition)) return; } while (0)
+
+#define CO_SLEEP_MS(ms) do { wakeAt = millis() + (ms); sleeping = true; CO_YIELD(); } while (0)
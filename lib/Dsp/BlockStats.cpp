@@ -0,0 +1,212 @@
+#include "BlockStats.h"
+#include <ArduinoLog.h>
+#include <math.h>
+#include <memory>
+
+#if BLOCK_STATS_USE_ESP_DSP
+#include <esp_dsp.h>
+
+// Summing is a dot product with ones, done in slices of this size
+static constexpr int ONES_LENGTH = 64;
+alignas(16) static const float ONES[ONES_LENGTH] = {
+    1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+    1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+};
+#endif
+
+// Integer abs sums of doubled 16-bit deviations fit in 32 bits up to this many samples
+static constexpr size_t INTEGER_CHUNK = 16384;
+
+void BlockStats::add(const float* samples, size_t count) {
+    if (count == 0) return;
+    const float c = center;
+
+    // Four independent lanes, so consecutive FPU operations do not wait on each other
+    float sum0 = 0.0f, sum1 = 0.0f, sum2 = 0.0f, sum3 = 0.0f;
+    float sq0 = 0.0f, sq1 = 0.0f, sq2 = 0.0f, sq3 = 0.0f;
+    float abs0 = 0.0f, abs1 = 0.0f, abs2 = 0.0f, abs3 = 0.0f;
+    float min0 = minimum, min1 = minimum, min2 = minimum, min3 = minimum;
+    float max0 = maximum, max1 = maximum, max2 = maximum, max3 = maximum;
+    float peak0 = peakAbs, peak1 = peakAbs, peak2 = peakAbs, peak3 = peakAbs;
+
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        float v0 = samples[i], v1 = samples[i + 1], v2 = samples[i + 2], v3 = samples[i + 3];
+#if !BLOCK_STATS_USE_ESP_DSP
+        sum0 += v0; sum1 += v1; sum2 += v2; sum3 += v3;
+        sq0 += v0 * v0; sq1 += v1 * v1; sq2 += v2 * v2; sq3 += v3 * v3;
+#endif
+        min0 = v0 < min0 ? v0 : min0; min1 = v1 < min1 ? v1 : min1;
+        min2 = v2 < min2 ? v2 : min2; min3 = v3 < min3 ? v3 : min3;
+        max0 = v0 > max0 ? v0 : max0; max1 = v1 > max1 ? v1 : max1;
+        max2 = v2 > max2 ? v2 : max2; max3 = v3 > max3 ? v3 : max3;
+        float d0 = fabsf(v0 - c), d1 = fabsf(v1 - c), d2 = fabsf(v2 - c), d3 = fabsf(v3 - c);
+        abs0 += d0; abs1 += d1; abs2 += d2; abs3 += d3;
+        peak0 = d0 > peak0 ? d0 : peak0; peak1 = d1 > peak1 ? d1 : peak1;
+        peak2 = d2 > peak2 ? d2 : peak2; peak3 = d3 > peak3 ? d3 : peak3;
+    }
+    for (; i < count; i++) {
+        float v = samples[i];
+#if !BLOCK_STATS_USE_ESP_DSP
+        sum0 += v;
+        sq0 += v * v;
+#endif
+        min0 = v < min0 ? v : min0;
+        max0 = v > max0 ? v : max0;
+        float d = fabsf(v - c);
+        abs0 += d;
+        peak0 = d > peak0 ? d : peak0;
+    }
+
+#if BLOCK_STATS_USE_ESP_DSP
+    for (size_t offset = 0; offset < count; offset += ONES_LENGTH) {
+        int length = count - offset < static_cast<size_t>(ONES_LENGTH) ? count - offset : ONES_LENGTH;
+        float slice;
+        dsps_dotprod_f32(samples + offset, ONES, &slice, length);
+        sum0 += slice;
+    }
+    dsps_dotprod_f32(samples, samples, &sq0, count);
+#endif
+
+    n += count;
+    total += (sum0 + sum1) + (sum2 + sum3);
+    totalSquares += (sq0 + sq1) + (sq2 + sq3);
+    totalAbs += (abs0 + abs1) + (abs2 + abs3);
+    minimum = fminf(fminf(min0, min1), fminf(min2, min3));
+    maximum = fmaxf(fmaxf(max0, max1), fmaxf(max2, max3));
+    peakAbs = fmaxf(fmaxf(peak0, peak1), fmaxf(peak2, peak3));
+}
+
+void BlockStats::add(const uint16_t* samples, size_t count) {
+    // Deviations are doubled, so that a center of k + 0.5 is still an integer
+    const int32_t center2 = static_cast<int32_t>(lroundf(2.0f * center));
+
+    while (count > 0) {
+        size_t chunk = count < INTEGER_CHUNK ? count : INTEGER_CHUNK;
+        uint32_t sum0 = 0, sum1 = 0;
+        uint64_t sq0 = 0, sq1 = 0;
+        uint32_t abs0 = 0, abs1 = 0;
+        uint32_t min0 = UINT16_MAX, min1 = UINT16_MAX;
+        uint32_t max0 = 0, max1 = 0;
+        uint32_t peak0 = 0, peak1 = 0;
+
+        size_t i = 0;
+        for (; i + 2 <= chunk; i += 2) {
+            uint32_t v0 = samples[i], v1 = samples[i + 1];
+            sum0 += v0; sum1 += v1;
+            sq0 += v0 * v0; sq1 += v1 * v1;
+            min0 = v0 < min0 ? v0 : min0; min1 = v1 < min1 ? v1 : min1;
+            max0 = v0 > max0 ? v0 : max0; max1 = v1 > max1 ? v1 : max1;
+            int32_t e0 = 2 * static_cast<int32_t>(v0) - center2, e1 = 2 * static_cast<int32_t>(v1) - center2;
+            uint32_t d0 = e0 < 0 ? -e0 : e0, d1 = e1 < 0 ? -e1 : e1;
+            abs0 += d0; abs1 += d1;
+            peak0 = d0 > peak0 ? d0 : peak0; peak1 = d1 > peak1 ? d1 : peak1;
+        }
+        if (i < chunk) {
+            uint32_t v = samples[i];
+            sum0 += v;
+            sq0 += v * v;
+            min0 = v < min0 ? v : min0;
+            max0 = v > max0 ? v : max0;
+            int32_t e = 2 * static_cast<int32_t>(v) - center2;
+            uint32_t d = e < 0 ? -e : e;
+            abs0 += d;
+            peak0 = d > peak0 ? d : peak0;
+        }
+
+        n += chunk;
+        total += static_cast<float>(sum0) + static_cast<float>(sum1);
+        totalSquares += static_cast<float>(sq0 + sq1);
+        totalAbs += 0.5f * (static_cast<float>(abs0) + static_cast<float>(abs1));
+        minimum = fminf(minimum, min0 < min1 ? min0 : min1);
+        maximum = fmaxf(maximum, max0 > max1 ? max0 : max1);
+        peakAbs = fmaxf(peakAbs, 0.5f * (peak0 > peak1 ? peak0 : peak1));
+
+        samples += chunk;
+        count -= chunk;
+    }
+}
+
+void BlockStats::addScalar(const float* samples, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        float v = samples[i];
+        n++;
+        total += v;
+        totalSquares += v * v;
+        if (v < minimum) minimum = v;
+        if (v > maximum) maximum = v;
+        float d = fabsf(v - center);
+        totalAbs += d;
+        if (d > peakAbs) peakAbs = d;
+    }
+}
+
+float BlockStats::variance() const {
+    if (n == 0) return 0.0f;
+    float m = total / n;
+    float v = totalSquares / n - m * m;
+    return v > 0.0f ? v : 0.0f;
+}
+
+static bool close(float a, float b) {
+    return fabsf(a - b) <= 1e-4f * fmaxf(1.0f, fmaxf(fabsf(a), fabsf(b)));
+}
+
+static bool agree(const BlockStats& a, const BlockStats& b) {
+    return a.count() == b.count() && close(a.sum(), b.sum()) && close(a.sumSquares(), b.sumSquares())
+           && a.min() == b.min() && a.max() == b.max() && close(a.absMean(), b.absMean()) && close(a.absPeak(), b.absPeak());
+}
+
+bool BlockStats::benchmark() {
+    constexpr size_t MAX_BLOCK = 1024;
+    constexpr uint8_t REPEATS = 8;
+    constexpr float ADC_CENTER = 2047.5f;
+
+    std::unique_ptr<float[]> floats(new float[MAX_BLOCK]);
+    std::unique_ptr<uint16_t[]> codes(new uint16_t[MAX_BLOCK]);
+    std::unique_ptr<float[]> codesAsFloat(new float[MAX_BLOCK]);
+
+    uint32_t state = 12345;
+    for (size_t i = 0; i < MAX_BLOCK; i++) {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        codes[i] = state & 0x0FFF;
+        codesAsFloat[i] = codes[i];
+        floats[i] = 9.81f + (static_cast<int32_t>(state >> 12 & 0xFFFF) - 32768) * 1e-4f;
+    }
+
+    bool ok = true;
+    for (size_t size = 16; size <= MAX_BLOCK; size *= 4) {
+        uint32_t scalarCycles = UINT32_MAX, floatCycles = UINT32_MAX, adcCycles = UINT32_MAX;
+        BlockStats reference, kernel, adcReference(ADC_CENTER), adcKernel(ADC_CENTER);
+
+        for (uint8_t r = 0; r < REPEATS; r++) {
+            reference.reset();
+            uint32_t start = ESP.getCycleCount();
+            reference.addScalar(floats.get(), size);
+            uint32_t elapsed = ESP.getCycleCount() - start;
+            if (elapsed < scalarCycles) scalarCycles = elapsed;
+
+            kernel.reset();
+            start = ESP.getCycleCount();
+            kernel.add(floats.get(), size);
+            elapsed = ESP.getCycleCount() - start;
+            if (elapsed < floatCycles) floatCycles = elapsed;
+
+            adcKernel.reset();
+            start = ESP.getCycleCount();
+            adcKernel.add(codes.get(), size);
+            elapsed = ESP.getCycleCount() - start;
+            if (elapsed < adcCycles) adcCycles = elapsed;
+        }
+        adcReference.addScalar(codesAsFloat.get(), size);
+
+        bool sizeOk = agree(reference, kernel) && agree(adcReference, adcKernel);
+        ok = ok && sizeOk;
+        Log.notice(F("[BlockStats] %u samples: scalar %u cycles, float kernel %u cycles (%F x), ADC kernel %u cycles%s" CR),
+                   size, scalarCycles, floatCycles, static_cast<float>(scalarCycles) / floatCycles, adcCycles,
+                   sizeOk ? "" : ", MISMATCH with the scalar reference");
+    }
+    return ok;
+}
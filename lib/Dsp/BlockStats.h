@@ -0,0 +1,65 @@
+#pragma once
+
+#include <Arduino.h>
+
+/**
+ * @brief Running statistics of sample blocks: count, sum, sum of squares, min, max, and the
+ * mean and peak of the absolute deviation from a fixed center (e.g. the bias of an AC signal).
+ * Samples are reduced a block at a time by kernels unrolled with independent accumulators,
+ * so the FPU pipeline stays busy; ADC blocks are reduced in integer arithmetic, exactly.
+ * Built with BLOCK_STATS_USE_ESP_DSP (the ESP32-S3 environment), the sums of float blocks
+ * use the esp-dsp dot product, which runs on the S3 SIMD unit; keep those blocks 16-byte
+ * aligned.
+ * addScalar() is the plain per-sample reference the kernels are checked against.
+ */
+class BlockStats {
+public:
+    /**
+     * @param center Reference of the absolute deviation statistics.
+     */
+    explicit BlockStats(float center = 0.0f) : center(center) {}
+
+    void add(const float* samples, size_t count);
+
+    /**
+     * Raw ADC codes (up to 16 bits). A center with a fractional part of .5 (e.g. 2047.5
+     * for 12 bits) is handled exactly.
+     */
+    void add(const uint16_t* samples, size_t count);
+
+    /**
+     * Reference implementation, one sample at a time.
+     */
+    void addScalar(const float* samples, size_t count);
+
+    void reset() { *this = BlockStats(center); }
+
+    uint32_t count() const { return n; }
+    float sum() const { return total; }
+    float sumSquares() const { return totalSquares; }
+    float min() const { return minimum; }
+    float max() const { return maximum; }
+    float peakToPeak() const { return n > 0 ? maximum - minimum : 0.0f; }
+    float mean() const { return n > 0 ? total / n : 0.0f; }
+    float rms() const { return n > 0 ? sqrtf(totalSquares / n) : 0.0f; }
+    float variance() const;
+    float absMean() const { return n > 0 ? totalAbs / n : 0.0f; }
+    float absPeak() const { return peakAbs; }
+
+    /**
+     * Times the kernels against the scalar reference on blocks of 16 to 1024 samples and
+     * checks that they agree; logs the CPU cycles per block.
+     * @return false if a kernel disagrees with the reference.
+     */
+    static bool benchmark();
+
+private:
+    float center;
+    uint32_t n = 0;
+    float total = 0.0f;
+    float totalSquares = 0.0f;
+    float totalAbs = 0.0f;
+    float minimum = INFINITY;
+    float maximum = -INFINITY;
+    float peakAbs = 0.0f;
+};
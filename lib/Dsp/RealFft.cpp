@@ -0,0 +1,120 @@
+#include "RealFft.h"
+#include <math.h>
+
+RealFft::RealFft(size_t size)
+    : n(size), twiddles(new float[size]), window(new float[size]), bitReverse(new uint16_t[size / 2]) {
+    const float pi = 3.14159265358979f;
+
+    for (size_t k = 0; k < n / 2; k++) {
+        float angle = -2.0f * pi * k / n;
+        twiddles[2 * k] = cosf(angle);
+        twiddles[2 * k + 1] = sinf(angle);
+    }
+
+    float sumSquares = 0.0f;
+    for (size_t i = 0; i < n; i++) {
+        window[i] = 0.5f - 0.5f * cosf(2.0f * pi * i / n);
+        sumSquares += window[i] * window[i];
+    }
+    powerScale = 1.0f / (static_cast<float>(n) * sumSquares);
+
+    size_t points = n / 2;
+    uint8_t bits = 0;
+    while ((1u << bits) < points) bits++;
+    for (size_t i = 0; i < points; i++) {
+        uint16_t reversed = 0;
+        for (uint8_t b = 0; b < bits; b++) {
+            if (i & (1u << b)) reversed |= 1u << (bits - 1 - b);
+        }
+        bitReverse[i] = reversed;
+    }
+}
+
+RealFft::~RealFft() {
+    delete[] twiddles;
+    delete[] window;
+    delete[] bitReverse;
+}
+
+void RealFft::applyWindow(float* data) const {
+    float mean = 0.0f;
+    for (size_t i = 0; i < n; i++) mean += data[i];
+    mean /= n;
+    for (size_t i = 0; i < n; i++) data[i] = (data[i] - mean) * window[i];
+}
+
+void RealFft::forward(float* data) const {
+    // Even samples as real parts, odd samples as imaginary parts
+    complexFft(data);
+
+    // Split the N/2 point complex spectrum Z into the N point real spectrum X:
+    // X[k] = E[k] + W^k O[k], X[N/2-k] = conj(E[k] - W^k O[k])
+    const size_t half = n / 2;
+    float z0re = data[0];
+    float z0im = data[1];
+    data[0] = z0re + z0im;
+    data[1] = z0re - z0im;
+
+    for (size_t k = 1; k <= half / 2; k++) {
+        size_t j = half - k;
+        float are = data[2 * k], aim = data[2 * k + 1];
+        float bre = data[2 * j], bim = data[2 * j + 1];
+
+        float ere = 0.5f * (are + bre);
+        float eim = 0.5f * (aim - bim);
+        float ore = 0.5f * (aim + bim);
+        float oim = -0.5f * (are - bre);
+
+        float wre = twiddles[2 * k], wim = twiddles[2 * k + 1];
+        float tre = wre * ore - wim * oim;
+        float tim = wre * oim + wim * ore;
+
+        data[2 * k] = ere + tre;
+        data[2 * k + 1] = eim + tim;
+        data[2 * j] = ere - tre;
+        data[2 * j + 1] = -(eim - tim);
+    }
+}
+
+/**
+ * Iterative decimation in time FFT of the N/2 interleaved complex points.
+ */
+void RealFft::complexFft(float* data) const {
+    const size_t points = n / 2;
+
+    for (size_t i = 0; i < points; i++) {
+        size_t j = bitReverse[i];
+        if (j > i) {
+            float re = data[2 * i], im = data[2 * i + 1];
+            data[2 * i] = data[2 * j];
+            data[2 * i + 1] = data[2 * j + 1];
+            data[2 * j] = re;
+            data[2 * j + 1] = im;
+        }
+    }
+
+    for (size_t len = 2; len <= points; len <<= 1) {
+        size_t halfLen = len / 2;
+        size_t step = n / len; // Twiddle table stride for this stage
+        for (size_t start = 0; start < points; start += len) {
+            for (size_t m = 0; m < halfLen; m++) {
+                float wre = twiddles[2 * m * step], wim = twiddles[2 * m * step + 1];
+                float* a = data + 2 * (start + m);
+                float* b = data + 2 * (start + m + halfLen);
+                float tre = wre * b[0] - wim * b[1];
+                float tim = wre * b[1] + wim * b[0];
+                b[0] = a[0] - tre;
+                b[1] = a[1] - tim;
+                a[0] += tre;
+                a[1] += tim;
+            }
+        }
+    }
+}
+
+float RealFft::binPower(const float* data, size_t k) const {
+    if (k == 0) return data[0] * data[0] * powerScale;
+    if (k == n / 2) return data[1] * data[1] * powerScale;
+    // Bins below Nyquist also hold the power of their negative frequency
+    return 2.0f * (data[2 * k] * data[2 * k] + data[2 * k + 1] * data[2 * k + 1]) * powerScale;
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <Arduino.h>
+
+/**
+ * @brief In-place radix-2 FFT of a real signal.
+ * The N real samples are transformed as N/2 complex points followed by a split step, so a
+ * real window costs about half of a complex FFT of the same length. The twiddle factors,
+ * the bit reversal permutation and the Hann window are computed once at construction.
+ *
+ * Output layout after forward(), for N samples:
+ *   data[0] = X[0] (DC, real), data[1] = X[N/2] (Nyquist, real),
+ *   data[2k], data[2k+1] = real and imaginary part of X[k] for 0 < k < N/2.
+ */
+class RealFft {
+public:
+    /**
+     * @param size Number of real samples, a power of two of at least 4.
+     */
+    explicit RealFft(size_t size);
+    ~RealFft();
+
+    RealFft(const RealFft&) = delete;
+    RealFft& operator=(const RealFft&) = delete;
+
+    size_t size() const { return n; }
+
+    /**
+     * Removes the mean and multiplies by the Hann window, in place.
+     */
+    void applyWindow(float* data) const;
+
+    /**
+     * Transforms data in place; see the class description for the output layout.
+     */
+    void forward(float* data) const;
+
+    /**
+     * Power of bin k (0 <= k <= N/2) after forward(), scaled so that the sum over all
+     * bins equals the mean square of the input signal (Parseval, corrected for the
+     * power lost to the window).
+     */
+    float binPower(const float* data, size_t k) const;
+
+private:
+    const size_t n;
+    float* twiddles;  // cos and sin of -2*pi*k/N for k < N/2, interleaved
+    float* window;    // Hann window
+    uint16_t* bitReverse; // Permutation of the N/2 complex points
+    float powerScale; // 1 / (N^2 * mean(window^2))
+
+    void complexFft(float* data) const;
+};
@@ -2,9 +2,21 @@
 #include <ArduinoLog.h>
 #include "../../include/SensorExceptions.h"
 
+// Stored with 1 mV and 1 LSB resolution while buffered
+static constexpr FieldSchema FIELD_SCHEMA[] = {
+    {"voltage", 0.001f, 0.0f},
+    {"raw", 1.0f, 0.0f},
+};
+
 void GenericAnalogInputSensor::begin() {
     // On most Arduino boards, analog pins do not require explicit initialization.
     // This method is provided for interface consistency and future extensibility.
+    if (scanner != nullptr) {
+        scanner->addPin(analogPin);
+        scanner->begin();
+    } else {
+        AdcScanner::claimDirectRead(analogPin);
+    }
     isInitialized = true;
     Log.notice(F("[GenericAnalogInput] Sensor initialized on pin %d" CR), analogPin);
 }
@@ -23,14 +35,31 @@ SensorResult GenericAnalogInputSensor::readValues(bool force, bool updateReadTim
     if (millis() - lastReadTime < updateInterval && !force) {
         return SensorResult(getSensorName());
     }
+    uint16_t scannedRaw = 0;
+    uint32_t scannedMillivolts = 0;
+    if (scanner != nullptr && !scanner->latest(analogPin, scannedRaw, scannedMillivolts)) {
+        return SensorResult(getSensorName()); // Scan has not produced a full average yet
+    }
     if (updateReadTime) {
         lastReadTime = millis();
     }
-    int rawValue = analogRead(analogPin);
-    float voltage = (static_cast<float>(rawValue) / 4095.0f) * referenceVoltage;
+    int rawValue;
+    float voltage;
+    if (scanner != nullptr) {
+        rawValue = scannedRaw;
+        voltage = scannedMillivolts / 1000.0f;
+    } else {
+        rawValue = analogRead(analogPin);
+        voltage = (static_cast<float>(rawValue) / 4095.0f) * referenceVoltage;
+    }
     SensorResult result(this->getSensorName());
     result.set("voltage", voltage); // Voltage in V (SI unit)
     result.set("raw", rawValue);    // Raw ADC value
     Log.verboseln(F("[GenericAnalogInput] Read voltage: %F V (raw: %d) on pin %d"), voltage, rawValue, analogPin);
     return result;
 }
+
+const FieldSchema* GenericAnalogInputSensor::getFieldSchema(uint8_t& count) const {
+    count = sizeof(FIELD_SCHEMA) / sizeof(FIELD_SCHEMA[0]);
+    return FIELD_SCHEMA;
+}
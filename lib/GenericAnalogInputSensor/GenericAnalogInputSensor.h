@@ -4,11 +4,14 @@
 #include "../../include/ISensor.h"
 #include "../../include/ResultCode.h"
 #include "SensorResult.h"
+#include "AdcScanner.h"
 
 /**
  * @brief Generic analog input sensor for reading voltage from an analog pin.
  * Reads the analog value and converts it to voltage (V) using the reference voltage.
  * Designed for simple analog sensors or voltage monitoring.
+ * When an AdcScanner is given, the pin is sampled by the shared continuous scan and
+ * readValues() returns its latest calibrated average instead of calling analogRead().
  */
 class GenericAnalogInputSensor : public ISensor {
 public:
@@ -17,17 +20,20 @@ public:
      * @param pin Analog pin to read from.
      * @param vRef Reference voltage for ADC conversion (default: 3.3V).
      * @param interval Update interval in ms (default: 60000 ms).
+     * @param scanner Optional shared ADC1 scanner (vRef is then unused, the eFuse calibration applies).
      */
-    GenericAnalogInputSensor(const char* sensorName, uint8_t pin, float vRef = 3.3f, unsigned long interval = 60000)
-        : ISensor(sensorName, interval), analogPin(pin), referenceVoltage(vRef) {}
+    GenericAnalogInputSensor(const char* sensorName, uint8_t pin, float vRef = 3.3f, unsigned long interval = 60000, AdcScanner* scanner = nullptr)
+        : ISensor(sensorName, interval), analogPin(pin), referenceVoltage(vRef), scanner(scanner) {}
     ~GenericAnalogInputSensor() override = default;
 
     void begin() override;
     void update() override;
     SensorResult readValues(bool force = false, bool updateReadTime = true) override;
+    const FieldSchema* getFieldSchema(uint8_t& count) const override;
 
 private:
     uint8_t analogPin;
     float referenceVoltage;
+    AdcScanner* scanner;
     bool isInitialized = false;
 };
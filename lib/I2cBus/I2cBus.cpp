@@ -0,0 +1,197 @@
+#include "I2cBus.h"
+#include <ArduinoLog.h>
+#include <esp_timer.h>
+
+// Status codes of TwoWire::endTransmission() on the ESP32
+static constexpr uint8_t WIRE_OK = 0;
+static constexpr uint8_t WIRE_NACK_ADDRESS = 2;
+static constexpr uint8_t WIRE_NACK_DATA = 3;
+static constexpr uint8_t WIRE_ERROR = 4;
+static constexpr uint8_t WIRE_TIMEOUT = 5;
+
+I2cBus* I2cBus::firstBus = nullptr;
+
+I2cBus::I2cBus(const char* name, TwoWire& wire, uint32_t frequency)
+    : busName(name), wire(wire), frequency(frequency) {
+    busMutex = xSemaphoreCreateMutex();
+    nextBus = firstBus;
+    firstBus = this;
+}
+
+I2cBus::~I2cBus() {
+    for (I2cBus** link = &firstBus; *link; link = &(*link)->nextBus) {
+        if (*link == this) {
+            *link = nextBus;
+            break;
+        }
+    }
+    if (task) vTaskDelete(task);
+    if (queue) vQueueDelete(queue);
+    if (busMutex) vSemaphoreDelete(busMutex);
+}
+
+void I2cBus::begin() {
+    if (task) {
+        return;
+    }
+    {
+        Lock lock(this);
+        wire.begin();
+        wire.setClock(frequency);
+        wire.setTimeOut(I2C_BUS_TIMEOUT_MS);
+    }
+    queue = xQueueCreate(I2C_BUS_QUEUE_DEPTH, sizeof(Item));
+    xTaskCreate(taskEntry, busName, I2C_BUS_TASK_STACK, this, I2C_BUS_TASK_PRIORITY, &task);
+    lastLogUs = esp_timer_get_time();
+    Log.notice(F("[I2cBus] %s started at %u kHz" CR), busName, frequency / 1000);
+}
+
+bool I2cBus::submit(const Transaction& transaction) {
+    return enqueue({transaction, nullptr, 1});
+}
+
+bool I2cBus::submit(const Transaction* transactions, size_t count) {
+    if (count == 0) return true;
+    return enqueue({transactions[0], transactions, count});
+}
+
+bool I2cBus::enqueue(const Item& item) {
+    if (queue == nullptr || xQueueSend(queue, &item, 0) != pdTRUE) {
+        portENTER_CRITICAL(&statsLock);
+        stats.rejected++;
+        portEXIT_CRITICAL(&statsLock);
+        return false;
+    }
+    uint32_t queued = uxQueueMessagesWaiting(queue);
+    portENTER_CRITICAL(&statsLock);
+    if (queued > stats.maxQueued) stats.maxQueued = queued;
+    portEXIT_CRITICAL(&statsLock);
+    return true;
+}
+
+bool I2cBus::transfer(const Transaction& transaction) {
+    // Before begin(), and from the callbacks, there is no task to wait for
+    if (task == nullptr || xTaskGetCurrentTaskHandle() == task) {
+        Lock lock(task == nullptr ? this : nullptr);
+        bool success = execute(transaction);
+        if (transaction.onComplete) transaction.onComplete(transaction.context, success);
+        return success;
+    }
+
+    struct Waiter {
+        TaskHandle_t task;
+        const Transaction* original;
+        volatile bool done;
+        volatile bool success;
+    } waiter = {xTaskGetCurrentTaskHandle(), &transaction, false, false};
+
+    Transaction waited = transaction;
+    waited.context = &waiter;
+    waited.onComplete = [](void* context, bool success) {
+        Waiter* w = static_cast<Waiter*>(context);
+        if (w->original->onComplete) w->original->onComplete(w->original->context, success);
+        // The waiter may return as soon as done is set
+        TaskHandle_t waiting = w->task;
+        w->success = success;
+        w->done = true;
+        xTaskNotifyGive(waiting);
+    };
+
+    // Waits for room rather than failing: the caller asked to block
+    Item item = {waited, nullptr, 1};
+    while (xQueueSend(queue, &item, 0) != pdTRUE) {
+        vTaskDelay(1);
+    }
+    while (!waiter.done) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    }
+    return waiter.success;
+}
+
+bool I2cBus::readRegisters(uint8_t address, uint8_t reg, uint8_t* data, uint8_t length) {
+    return transfer({address, reg, nullptr, 0, data, length, nullptr, nullptr});
+}
+
+bool I2cBus::execute(const Transaction& transaction) {
+    int64_t start = esp_timer_get_time();
+
+    wire.beginTransmission(transaction.address);
+    wire.write(transaction.reg);
+    if (transaction.writeLength > 0) {
+        wire.write(transaction.writeData, transaction.writeLength);
+    }
+    // Keep the bus for a repeated start if a read follows
+    uint8_t error = wire.endTransmission(transaction.readLength == 0);
+    if (error == WIRE_OK && transaction.readLength > 0) {
+        size_t received = wire.requestFrom(transaction.address, static_cast<size_t>(transaction.readLength));
+        if (received == transaction.readLength) {
+            wire.readBytes(transaction.readData, transaction.readLength);
+        } else {
+            error = WIRE_ERROR;
+        }
+    }
+
+    recordResult(error, transaction, static_cast<uint32_t>(esp_timer_get_time() - start));
+    return error == WIRE_OK;
+}
+
+void I2cBus::recordResult(uint8_t error, const Transaction& transaction, uint32_t elapsedUs) {
+    portENTER_CRITICAL(&statsLock);
+    stats.transactions++;
+    stats.busyUs += elapsedUs;
+    if (elapsedUs > stats.maxTransactionUs) stats.maxTransactionUs = elapsedUs;
+    if (error == WIRE_OK) {
+        stats.bytes += 1 + transaction.writeLength + transaction.readLength;
+    } else if (error == WIRE_NACK_ADDRESS || error == WIRE_NACK_DATA) {
+        stats.nacks++;
+    } else if (error == WIRE_TIMEOUT) {
+        stats.timeouts++;
+    } else {
+        stats.otherErrors++;
+    }
+    portEXIT_CRITICAL(&statsLock);
+}
+
+void I2cBus::runBatch(const Item& item) {
+    const Transaction* transactions = item.batch ? item.batch : &item.transaction;
+    Lock lock(this);
+    for (size_t i = 0; i < item.count; i++) {
+        bool success = execute(transactions[i]);
+        if (transactions[i].onComplete) transactions[i].onComplete(transactions[i].context, success);
+    }
+}
+
+I2cBus::Stats I2cBus::getStats() const {
+    portENTER_CRITICAL(&statsLock);
+    Stats copy = stats;
+    portEXIT_CRITICAL(&statsLock);
+    return copy;
+}
+
+void I2cBus::logStats() {
+    Stats s = getStats();
+    int64_t now = esp_timer_get_time();
+    float utilization = now > lastLogUs ? 100.0f * (s.busyUs - lastLogBusyUs) / (now - lastLogUs) : 0.0f;
+    lastLogUs = now;
+    lastLogBusyUs = s.busyUs;
+
+    Log.notice(F("[I2cBus] %s: %u transactions (%u bytes), %F%% busy, max %u us, %u NACKs, %u timeouts, %u errors, %u rejected, max %u queued\n"),
+               busName, s.transactions, static_cast<uint32_t>(s.bytes), utilization, s.maxTransactionUs,
+               s.nacks, s.timeouts, s.otherErrors, s.rejected, s.maxQueued);
+}
+
+void I2cBus::logAllStats() {
+    for (I2cBus* bus = firstBus; bus; bus = bus->nextBus) {
+        if (bus->task) bus->logStats();
+    }
+}
+
+void I2cBus::taskEntry(void* arg) {
+    I2cBus* bus = static_cast<I2cBus*>(arg);
+    Item item;
+    for (;;) {
+        if (xQueueReceive(bus->queue, &item, portMAX_DELAY) == pdTRUE) {
+            bus->runBatch(item);
+        }
+    }
+}
@@ -0,0 +1,156 @@
+#pragma once
+
+#include <Arduino.h>
+#include <Wire.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
+#include "settings.h"
+
+/**
+ * @brief Shared I2C bus running the register transactions of many drivers from one task.
+ * Drivers queue register bursts (write a register address, then write or read a block)
+ * and are called back when they complete, so the loop never waits on the bus and the
+ * sensors sharing it are served in order. A batch of transactions runs back to back,
+ * without other transactions in between.
+ * Libraries that talk to the bus themselves (e.g. for configuration) must hold a Lock
+ * around their calls, so they never interleave with the bus task.
+ */
+class I2cBus {
+public:
+    /**
+     * Called from the bus task when a transaction completes, with the bus held: keep it
+     * short and do not take a Lock from it.
+     */
+    using Callback = void (*)(void* context, bool success);
+
+    /**
+     * Writes reg followed by writeLength bytes; then, if readLength > 0, reads readLength
+     * bytes after a repeated start. The buffers must stay valid until the callback.
+     */
+    struct Transaction {
+        uint8_t address;
+        uint8_t reg;
+        const uint8_t* writeData;
+        uint8_t writeLength;
+        uint8_t* readData;
+        uint8_t readLength;
+        Callback onComplete; // May be nullptr
+        void* context;
+    };
+
+    struct Stats {
+        uint32_t transactions = 0;
+        uint32_t nacks = 0;        // Device or register not acknowledged
+        uint32_t timeouts = 0;
+        uint32_t otherErrors = 0;  // Bus errors and short reads
+        uint32_t rejected = 0;     // Queue full
+        uint64_t bytes = 0;        // Payload and register bytes, addresses excluded
+        uint64_t busyUs = 0;       // Time spent in transactions
+        uint32_t maxTransactionUs = 0;
+        uint32_t maxQueued = 0;
+    };
+
+    /**
+     * Holds the bus for direct library calls. Does nothing if bus is nullptr, so drivers
+     * can lock unconditionally whether or not they were given a bus.
+     */
+    class Lock {
+    public:
+        explicit Lock(I2cBus* bus) : bus(bus) {
+            if (bus) xSemaphoreTake(bus->busMutex, portMAX_DELAY);
+        }
+        ~Lock() {
+            if (bus) xSemaphoreGive(bus->busMutex);
+        }
+        Lock(const Lock&) = delete;
+        Lock& operator=(const Lock&) = delete;
+
+    private:
+        I2cBus* const bus;
+    };
+
+    /**
+     * @param name Name of the bus, used for logging and as task name.
+     * @param wire Controller of the bus.
+     * @param frequency Clock in Hz: 100 kHz, 400 kHz, or up to 1 MHz with Fast-mode Plus devices.
+     */
+    explicit I2cBus(const char* name = "I2C0", TwoWire& wire = Wire, uint32_t frequency = I2C_BUS_FREQUENCY);
+    ~I2cBus();
+
+    I2cBus(const I2cBus&) = delete;
+    I2cBus& operator=(const I2cBus&) = delete;
+
+    /**
+     * Starts the controller and the bus task. Does nothing if already started, so every
+     * driver sharing the bus can call it.
+     */
+    void begin();
+
+    /**
+     * Queues a transaction. Never blocks.
+     * @return false if the queue is full; the callback is not called.
+     */
+    bool submit(const Transaction& transaction);
+
+    /**
+     * Queues transactions to run back to back. Never blocks.
+     * The array itself must stay valid until the last callback.
+     * @return false if the queue is full; no callback is called.
+     */
+    bool submit(const Transaction* transactions, size_t count);
+
+    /**
+     * Runs a transaction and waits for it, behind the ones already queued. Wire's own
+     * timeout bounds the wait. Runs inline before begin().
+     * @return true if the transaction succeeded.
+     */
+    bool transfer(const Transaction& transaction);
+
+    /**
+     * Reads length consecutive registers from reg, waiting for the result.
+     */
+    bool readRegisters(uint8_t address, uint8_t reg, uint8_t* data, uint8_t length);
+
+    TwoWire& getWire() { return wire; }
+    const char* getName() const { return busName; }
+    Stats getStats() const;
+
+    /**
+     * Logs the counters and the utilization since the previous call.
+     */
+    void logStats();
+
+    /**
+     * Logs the stats of every bus created.
+     */
+    static void logAllStats();
+
+private:
+    struct Item {
+        Transaction transaction;  // Used when batch is nullptr
+        const Transaction* batch;
+        size_t count;
+    };
+
+    const char* busName;
+    TwoWire& wire;
+    const uint32_t frequency;
+    QueueHandle_t queue = nullptr;
+    SemaphoreHandle_t busMutex = nullptr; // Held while a batch runs, or by a Lock
+    TaskHandle_t task = nullptr;
+    Stats stats;
+    mutable portMUX_TYPE statsLock = portMUX_INITIALIZER_UNLOCKED;
+    uint64_t lastLogBusyUs = 0;
+    int64_t lastLogUs = 0;
+
+    I2cBus* nextBus = nullptr;
+    static I2cBus* firstBus;
+
+    bool enqueue(const Item& item);
+    bool execute(const Transaction& transaction);
+    void recordResult(uint8_t error, const Transaction& transaction, uint32_t elapsedUs);
+    void runBatch(const Item& item);
+    static void taskEntry(void* arg);
+};
@@ -0,0 +1,61 @@
+#include "AdaptiveBatchController.h"
+#include <ArduinoLog.h>
+
+// Weight of the latest sample in the moving averages
+constexpr float EWMA_ALPHA = 0.2f;
+
+AdaptiveBatchController::AdaptiveBatchController() : backoff(LOG_SINK_BACKOFF_MIN_MS, LOG_SINK_BACKOFF_MAX_MS) {}
+
+void AdaptiveBatchController::recordSend(bool success, unsigned long latencyMs, size_t points) {
+    portENTER_CRITICAL(&lock);
+    failureRate += EWMA_ALPHA * ((success ? 0.0f : 1.0f) - failureRate);
+
+    if (!success) {
+        backoff.next();
+        currentBatchSize = max<uint16_t>(ADAPTIVE_BATCH_MIN_POINTS, currentBatchSize / 2);
+        portEXIT_CRITICAL(&lock);
+        return;
+    }
+
+    backoff.reset();
+    avgLatencyMs += EWMA_ALPHA * (latencyMs - avgLatencyMs);
+    if (latencyMs <= ADAPTIVE_TARGET_LATENCY_MS) {
+        // Only grow if the batch was actually full, otherwise size is not the limit
+        if (points >= currentBatchSize) {
+            currentBatchSize = min<uint16_t>(ADAPTIVE_BATCH_MAX_POINTS, currentBatchSize + ADAPTIVE_BATCH_STEP_POINTS);
+        }
+        flushIntervalMs = max<unsigned long>(ADAPTIVE_FLUSH_INTERVAL_MIN_MS, flushIntervalMs * 9 / 10);
+    } else {
+        currentBatchSize = max<uint16_t>(ADAPTIVE_BATCH_MIN_POINTS, currentBatchSize * 3 / 4);
+        flushIntervalMs = min<unsigned long>(ADAPTIVE_FLUSH_INTERVAL_MAX_MS, flushIntervalMs * 5 / 4);
+    }
+    portEXIT_CRITICAL(&lock);
+}
+
+uint16_t AdaptiveBatchController::batchSize() const {
+    portENTER_CRITICAL(&lock);
+    uint16_t size = currentBatchSize;
+    portEXIT_CRITICAL(&lock);
+    return size;
+}
+
+unsigned long AdaptiveBatchController::nextFlushDelayMs() const {
+    portENTER_CRITICAL(&lock);
+    unsigned long delayMs = backoff.failures() > 0 ? backoff.currentDelay() : flushIntervalMs;
+    portEXIT_CRITICAL(&lock);
+    return delayMs;
+}
+
+AdaptiveBatchController::State AdaptiveBatchController::getState() const {
+    portENTER_CRITICAL(&lock);
+    State state = {currentBatchSize, flushIntervalMs, backoff.currentDelay(), backoff.failures(), failureRate, avgLatencyMs};
+    portEXIT_CRITICAL(&lock);
+    return state;
+}
+
+void AdaptiveBatchController::logState(const char* owner) const {
+    State state = getState();
+    Log.notice(F("[%s] Batching: %u points, flush every %u ms, backoff %u ms (%u failures), failure rate %F, latency %F ms\n"),
+               owner, state.batchSize, state.flushIntervalMs, state.backoffMs, state.consecutiveFailures,
+               state.failureRate, state.avgLatencyMs);
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include "settings.h"
+#include "Backoff.h"
+
+/**
+ * @brief Tunes batch size and flush interval from the outcome of each send.
+ * Successful sends faster than ADAPTIVE_TARGET_LATENCY_MS grow the batch additively and
+ * shorten the interval; slow sends shrink the batch multiplicatively and lengthen the
+ * interval; failures halve the batch and start a jittered exponential backoff.
+ * Everything stays within the configured bounds, so RAM use is capped by the maximum
+ * batch size. Every network sink has its own controller (see LogSink::getController()),
+ * so a failing destination does not throttle the others. Sends are reported from the sink
+ * task, so all methods are thread safe.
+ */
+class AdaptiveBatchController {
+public:
+    struct State {
+        uint16_t batchSize;        // Maximum points per batch
+        unsigned long flushIntervalMs;
+        unsigned long backoffMs;   // 0 when not backing off
+        uint32_t consecutiveFailures;
+        float failureRate;         // Exponentially weighted, 0..1
+        float avgLatencyMs;        // Exponentially weighted
+    };
+
+    AdaptiveBatchController();
+
+    /**
+     * Reports the outcome of a send.
+     * @param success Whether the destination accepted the batch.
+     * @param latencyMs Time the send took.
+     * @param points Number of points in the batch.
+     */
+    void recordSend(bool success, unsigned long latencyMs, size_t points);
+
+    uint16_t batchSize() const;
+
+    /**
+     * Delay before the next flush: the flush interval, or the backoff after a failure.
+     */
+    unsigned long nextFlushDelayMs() const;
+
+    State getState() const;
+
+    /**
+     * @param owner Name of the sink the controller tunes, for the log.
+     */
+    void logState(const char* owner) const;
+
+private:
+    mutable portMUX_TYPE lock = portMUX_INITIALIZER_UNLOCKED;
+    uint16_t currentBatchSize = ADAPTIVE_BATCH_INITIAL_POINTS;
+    unsigned long flushIntervalMs = LOG_INTERVAL;
+    float failureRate = 0.0f;
+    float avgLatencyMs = 0.0f;
+    Backoff backoff;
+};
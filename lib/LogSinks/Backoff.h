@@ -0,0 +1,45 @@
+#pragma once
+
+#include <Arduino.h>
+
+/**
+ * @brief Exponential backoff with jitter.
+ * The nominal delay doubles on every failure between minMs and maxMs; the returned delay
+ * is picked at random in [nominal/2, nominal] so that devices failing together do not
+ * retry in lockstep.
+ */
+class Backoff {
+public:
+    Backoff(unsigned long minMs, unsigned long maxMs) : minMs(minMs), maxMs(maxMs) {}
+
+    /**
+     * Records a failure.
+     * @return Delay to wait before the next attempt, in ms.
+     */
+    unsigned long next() {
+        nominalMs = nominalMs == 0 ? minMs : nominalMs * 2;
+        if (nominalMs > maxMs) nominalMs = maxMs;
+        failureCount++;
+        delayMs = nominalMs / 2 + random(nominalMs / 2 + 1);
+        return delayMs;
+    }
+
+    /**
+     * Records a success.
+     */
+    void reset() {
+        nominalMs = 0;
+        delayMs = 0;
+        failureCount = 0;
+    }
+
+    unsigned long currentDelay() const { return delayMs; }
+    uint32_t failures() const { return failureCount; }
+
+private:
+    const unsigned long minMs;
+    const unsigned long maxMs;
+    unsigned long nominalMs = 0;
+    unsigned long delayMs = 0;
+    uint32_t failureCount = 0;
+};
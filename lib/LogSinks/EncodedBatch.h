@@ -0,0 +1,18 @@
+#pragma once
+
+#include <Arduino.h>
+#include <memory>
+
+/**
+ * @brief A batch of readings encoded once in InfluxDB line protocol.
+ * Batches are immutable once sealed and shared between sinks, so every sink
+ * sends the same buffer without re-encoding or copying it.
+ */
+struct EncodedBatch {
+    String body;                 // One line protocol record per line
+    size_t points = 0;
+    unsigned long createdAt = 0; // millis() when the batch was sealed, or when the reading was taken if urgent
+    bool urgent = false;         // Alarm-class reading sent on the priority lane
+};
+
+using EncodedBatchPtr = std::shared_ptr<const EncodedBatch>;
@@ -0,0 +1,80 @@
+#include "HttpConnection.h"
+#include <ArduinoLog.h>
+
+bool HttpConnection::begin() {
+    const char* rest;
+    if (strncmp(serverUrl, "https://", 8) == 0) {
+        secure = true;
+        rest = serverUrl + 8;
+    } else if (strncmp(serverUrl, "http://", 7) == 0) {
+        secure = false;
+        rest = serverUrl + 7;
+    } else {
+        return false;
+    }
+
+    const char* pathStart = strchr(rest, '/');
+    size_t authorityLength = pathStart ? pathStart - rest : strlen(rest);
+    const char* colon = static_cast<const char*>(memchr(rest, ':', authorityLength));
+    size_t hostLength = colon ? colon - rest : authorityLength;
+    if (hostLength == 0) return false;
+
+    host = "";
+    for (size_t i = 0; i < hostLength; i++) host += rest[i];
+    port = colon ? static_cast<uint16_t>(atoi(colon + 1)) : (secure ? 443 : 80);
+
+    basePath = "";
+    for (const char* c = pathStart; c && *c && !(c[0] == '/' && c[1] == '\0'); c++) basePath += *c;
+
+    secureClient.setInsecure();
+    return true;
+}
+
+WiFiClient* HttpConnection::acquire() {
+    if (client().connected()) {
+        stats.reuses++;
+        return &client();
+    }
+    client().stop(); // Release the socket of a connection closed by the server
+
+    // connect() is not virtual: call it on the concrete client
+    unsigned long start = millis();
+    bool connected = secure ? secureClient.connect(host.c_str(), port, HTTP_CONNECT_TIMEOUT_MS)
+                            : plainClient.connect(host.c_str(), port, HTTP_CONNECT_TIMEOUT_MS);
+    uint32_t elapsed = millis() - start;
+    if (!connected) {
+        stats.failedConnects++;
+        Log.errorln(F("[HttpConnection] Could not connect to %s:%u"), host.c_str(), port);
+        return nullptr;
+    }
+    stats.connects++;
+    stats.lastConnectMs = elapsed;
+    stats.totalConnectMs += elapsed;
+    if (elapsed > stats.maxConnectMs) stats.maxConnectMs = elapsed;
+    Log.verboseln(F("[HttpConnection] Connected to %s:%u in %u ms%s"), host.c_str(), port, elapsed, secure ? " (TLS)" : "");
+    lastUsedAt = millis();
+    return &client();
+}
+
+void HttpConnection::release(bool keepAlive) {
+    lastUsedAt = millis();
+    if (!keepAlive) close();
+}
+
+void HttpConnection::closeIfIdle() {
+    if (!client().connected() || millis() - lastUsedAt < HTTP_IDLE_TIMEOUT_MS) return;
+    stats.idleCloses++;
+    close();
+}
+
+void HttpConnection::close() {
+    client().stop();
+}
+
+void HttpConnection::logStats(const char* owner) const {
+    if (stats.connects == 0 && stats.failedConnects == 0) return;
+    Log.notice(F("[%s] %u %s (%u failed), avg %u ms max %u ms, %u requests on open connections, %u idle closes\n"),
+               owner, stats.connects, secure ? "TLS handshakes" : "connects", stats.failedConnects,
+               stats.connects > 0 ? static_cast<uint32_t>(stats.totalConnectMs / stats.connects) : 0,
+               stats.maxConnectMs, stats.reuses, stats.idleCloses);
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <Arduino.h>
+#include <WiFiClientSecure.h>
+#include "settings.h"
+
+/**
+ * @brief Persistent connection to an HTTP(S) server, shared by the requests of one task.
+ * It is opened on demand and kept open between requests (keep-alive), so the TLS handshake,
+ * hundreds of ms of CPU on the ESP32, is paid once per connection instead of once per
+ * request. After HTTP_IDLE_TIMEOUT_MS without requests it is closed, before the server or a
+ * NAT drops it silently and the next request fails on a dead socket.
+ * Connects are counted and timed: over https each one is a full TLS handshake.
+ * Not thread safe: use one instance per task.
+ */
+class HttpConnection {
+public:
+    struct Stats {
+        uint32_t connects = 0;       // TLS handshakes over https
+        uint32_t failedConnects = 0;
+        uint32_t reuses = 0;         // Requests sent on an already open connection
+        uint32_t idleCloses = 0;
+        uint32_t lastConnectMs = 0;
+        uint32_t maxConnectMs = 0;
+        uint64_t totalConnectMs = 0;
+    };
+
+    /**
+     * @param serverUrl Base URL of the server, including scheme (e.g. https://host:8086),
+     *                  optionally followed by a base path.
+     */
+    explicit HttpConnection(const char* serverUrl) : serverUrl(serverUrl) {}
+
+    HttpConnection(const HttpConnection&) = delete;
+    HttpConnection& operator=(const HttpConnection&) = delete;
+
+    /**
+     * Parses the URL. Called once before the first request.
+     * @return false if the URL is not http(s)://host[:port][/path].
+     */
+    bool begin();
+
+    /**
+     * Returns the open connection, or opens a new one.
+     * @return nullptr if the server could not be reached.
+     */
+    WiFiClient* acquire();
+
+    /**
+     * Ends a request. The connection stays open for the next one unless keepAlive is false
+     * (e.g. the server answered "Connection: close", or the response was not fully read).
+     */
+    void release(bool keepAlive = true);
+
+    /**
+     * Closes the connection if it was not used for HTTP_IDLE_TIMEOUT_MS.
+     * Call it periodically, e.g. from LogSink::poll().
+     */
+    void closeIfIdle();
+
+    void close();
+
+    bool isSecure() const { return secure; }
+    const String& getHost() const { return host; }
+    uint16_t getPort() const { return port; }
+    const String& getBasePath() const { return basePath; } // Without the trailing slash
+
+    /**
+     * TLS client, e.g. to set a CA certificate. Certificates are not checked by default.
+     */
+    WiFiClientSecure& getSecureClient() { return secureClient; }
+
+    const Stats& getStats() const { return stats; }
+    void logStats(const char* owner) const;
+
+private:
+    const char* serverUrl;
+    bool secure = false;
+    String host;
+    uint16_t port = 0;
+    String basePath;
+    WiFiClientSecure secureClient;
+    WiFiClient plainClient;
+    unsigned long lastUsedAt = 0;
+    Stats stats;
+
+    WiFiClient& client() { return secure ? static_cast<WiFiClient&>(secureClient) : plainClient; }
+};
@@ -0,0 +1,73 @@
+#include "InfluxHttpSink.h"
+#include <ArduinoLog.h>
+
+void InfluxHttpSink::setup() {
+    if (!connection.begin()) {
+        Log.errorln(F("[%s] Invalid server URL"), sinkName);
+    }
+    writeUrl = String(connection.isSecure() ? "https://" : "http://") + connection.getHost() + ":" + String(static_cast<int>(connection.getPort()))
+               + connection.getBasePath() + "/api/v2/write?org=" + urlEncode(org) + "&bucket=" + urlEncode(bucket) + "&precision=ms";
+    authorization = String("Token ") + token;
+    http.setReuse(true);
+    static const char* headers[] = {"Retry-After"};
+    http.collectHeaders(headers, 1);
+    Log.notice(F("[%s] Writing to %s" CR), sinkName, writeUrl.c_str());
+}
+
+bool InfluxHttpSink::send(const EncodedBatch& batch) {
+    // HTTPClient sends on the client as is when it is already connected
+    WiFiClient* client = connection.acquire();
+    if (client == nullptr) {
+        return false;
+    }
+    if (!http.begin(*client, writeUrl)) {
+        Log.errorln(F("[%s] Invalid URL: %s"), sinkName, writeUrl.c_str());
+        connection.release(false);
+        return false;
+    }
+    http.addHeader("Authorization", authorization);
+    http.addHeader("Content-Type", "text/plain; charset=utf-8");
+
+    // POST straight from the shared batch buffer, no copy
+    int code = http.POST(reinterpret_cast<uint8_t*>(const_cast<char*>(batch.body.c_str())), batch.body.length());
+    bool success = code >= 200 && code < 300;
+    if (code == 429 || code == 503) {
+        // InfluxDB throttling; Retry-After is in seconds
+        long retryAfter = http.header("Retry-After").toInt();
+        if (retryAfter > 0) setRetryAfter(retryAfter * 1000UL);
+    } else if (isRejection(code)) {
+        rejectBatch();
+    }
+    if (!success) {
+        Log.errorln(F("[%s] Write failed, HTTP %d: %s"), sinkName, code,
+                    code > 0 ? http.getString().c_str() : http.errorToString(code).c_str());
+    }
+    // Keeps the connection open unless the server closes it or the response was not read
+    http.end();
+    connection.release(client->connected());
+    return success;
+}
+
+void InfluxHttpSink::poll() {
+    connection.closeIfIdle();
+}
+
+void InfluxHttpSink::logStats() const {
+    LogSink::logStats();
+    connection.logStats(sinkName);
+}
+
+String InfluxHttpSink::urlEncode(const char* value) {
+    static const char hex[] = "0123456789ABCDEF";
+    String encoded;
+    for (const char* c = value; *c; c++) {
+        if (isalnum(static_cast<unsigned char>(*c)) || *c == '-' || *c == '_' || *c == '.' || *c == '~') {
+            encoded += *c;
+        } else {
+            encoded += '%';
+            encoded += hex[(*c >> 4) & 0x0F];
+            encoded += hex[*c & 0x0F];
+        }
+    }
+    return encoded;
+}
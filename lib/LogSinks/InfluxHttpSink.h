@@ -0,0 +1,47 @@
+#pragma once
+
+#include <Arduino.h>
+#include <HTTPClient.h>
+#include "LogSink.h"
+#include "HttpConnection.h"
+
+/**
+ * @brief Sends batches to the InfluxDB v2 HTTP write API (/api/v2/write).
+ * Batches share one kept-alive connection, closed when idle (see HttpConnection).
+ */
+class InfluxHttpSink : public LogSink {
+public:
+    /**
+     * @param serverUrl Base URL of the InfluxDB server, including scheme (e.g. https://host:8086).
+     * @param org InfluxDB organization.
+     * @param bucket InfluxDB bucket.
+     * @param token InfluxDB authentication token.
+     */
+    InfluxHttpSink(const char* serverUrl, const char* org, const char* bucket, const char* token)
+        : LogSink("InfluxHttp", LOG_SINK_QUEUE_DEPTH, INFLUX_SINK_TASK_STACK),
+          connection(serverUrl), org(org), bucket(bucket), token(token) {}
+
+    void logStats() const override;
+
+    static String urlEncode(const char* value);
+
+    /**
+     * Whether InfluxDB refused a write for good: a 4xx status other than 408 (timeout) and
+     * 429 (throttling), e.g. 400 for malformed line protocol. Retrying it cannot succeed.
+     */
+    static bool isRejection(int code) { return code >= 400 && code < 500 && code != 408 && code != 429; }
+
+protected:
+    void setup() override;
+    bool send(const EncodedBatch& batch) override;
+    void poll() override;
+
+private:
+    HttpConnection connection;
+    const char* org;
+    const char* bucket;
+    const char* token;
+    String writeUrl;
+    String authorization;
+    HTTPClient http;
+};
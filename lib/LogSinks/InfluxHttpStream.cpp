@@ -0,0 +1,217 @@
+#include "InfluxHttpStream.h"
+#include <ArduinoLog.h>
+#include "InfluxHttpSink.h"
+
+bool InfluxHttpStream::begin() {
+    if (requestPath.length() == 0) {
+        if (!connection.begin()) {
+            Log.errorln(F("[InfluxStream] Invalid URL"));
+            return false;
+        }
+        requestPath = connection.getBasePath() + "/api/v2/write?org=" + InfluxHttpSink::urlEncode(org)
+                      + "&bucket=" + InfluxHttpSink::urlEncode(bucket) + "&precision=ms";
+    }
+    abort(); // Leftovers of a request that was not finished
+    rejected = false;
+    if (retryInMs() > 0) {
+        Log.warningln(F("[InfluxStream] Throttled by the server, retrying in %u s"), retryInMs() / 1000);
+        return false;
+    }
+
+    startedAt = millis();
+    throttled = false;
+    chunkLength = 0;
+    bodyBytes = 0;
+    connection.closeIfIdle(); // Bursts are far apart: do not write into a connection the server dropped
+    client = connection.acquire();
+    if (client == nullptr) {
+        endRequest(false, 0, false);
+        return false;
+    }
+
+    String headers;
+    headers.reserve(256 + requestPath.length());
+    headers += "POST ";
+    headers += requestPath;
+    headers += " HTTP/1.1\r\nHost: ";
+    headers += connection.getHost();
+    headers += "\r\nAuthorization: Token ";
+    headers += token;
+    headers += "\r\nContent-Type: text/plain; charset=utf-8\r\n"
+               "Transfer-Encoding: chunked\r\n\r\n";
+    if (!writeRaw(headers.c_str(), headers.length())) {
+        endRequest(false, 0, false);
+        return false;
+    }
+    return true;
+}
+
+bool InfluxHttpStream::write(const char* data, size_t length) {
+    if (client == nullptr) return false;
+    while (length > 0) {
+        size_t room = INFLUX_STREAM_CHUNK_SIZE - chunkLength;
+        size_t part = length < room ? length : room;
+        memcpy(chunk + chunkLength, data, part);
+        chunkLength += part;
+        data += part;
+        length -= part;
+        if (chunkLength == INFLUX_STREAM_CHUNK_SIZE && !flushChunk()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool InfluxHttpStream::finish(size_t points) {
+    if (client == nullptr) return false;
+    if (!flushChunk() || !writeRaw("0\r\n\r\n", 5)) {
+        endRequest(false, points, false);
+        return false;
+    }
+
+    bool keepAlive;
+    int code = readResponse(keepAlive);
+    bool success = code >= 200 && code < 300;
+    rejected = InfluxHttpSink::isRejection(code);
+    if (rejected) {
+        stats.rejectedRequests++;
+        stats.rejectedPoints += points;
+        Log.errorln(F("[InfluxStream] Write of %u points rejected, HTTP %d"), points, code);
+    } else if (!success) {
+        Log.errorln(F("[InfluxStream] Write of %u points failed, HTTP %d"), points, code);
+    }
+    endRequest(success, points, keepAlive);
+    return success;
+}
+
+void InfluxHttpStream::abort() {
+    if (client == nullptr) return;
+    endRequest(false, 0, false);
+}
+
+unsigned long InfluxHttpStream::retryInMs() const {
+    if (!throttled) return 0;
+    long left = static_cast<long>(retryAt - millis());
+    return left > 0 ? left : 0;
+}
+
+void InfluxHttpStream::logStats() const {
+    Log.notice(F("[InfluxStream] %u requests (%u failed, %u rejected), %u points (%u rejected), %u bytes, last %u ms, max %u ms\n"),
+               stats.requests, stats.failedRequests, stats.rejectedRequests, stats.sentPoints, stats.rejectedPoints,
+               static_cast<uint32_t>(stats.sentBytes), stats.lastRequestMs, stats.maxRequestMs);
+    connection.logStats("InfluxStream");
+}
+
+/**
+ * Sends the buffered records as one HTTP chunk.
+ */
+bool InfluxHttpStream::flushChunk() {
+    if (chunkLength == 0) return true;
+    char size[12];
+    int sizeLength = snprintf(size, sizeof(size), "%X\r\n", static_cast<unsigned>(chunkLength));
+    if (!writeRaw(size, sizeLength) || !writeRaw(chunk, chunkLength) || !writeRaw("\r\n", 2)) {
+        return false;
+    }
+    bodyBytes += chunkLength;
+    chunkLength = 0;
+    return true;
+}
+
+bool InfluxHttpStream::writeRaw(const void* data, size_t length) {
+    if (client->write(static_cast<const uint8_t*>(data), length) != length) {
+        Log.errorln(F("[InfluxStream] Connection lost after %u bytes"), bodyBytes);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Reads a header line, without its CRLF. Longer lines are truncated.
+ * @return false if the connection closed or the deadline passed first.
+ */
+bool InfluxHttpStream::readLine(char* line, size_t size, unsigned long deadline) {
+    size_t length = 0;
+    for (;;) {
+        if (!client->available()) {
+            if (!client->connected() || static_cast<long>(millis() - deadline) >= 0) return false;
+            delay(1);
+            continue;
+        }
+        int c = client->read();
+        if (c == '\n') break;
+        if (c != '\r' && length + 1 < size) line[length++] = static_cast<char>(c);
+    }
+    line[length] = '\0';
+    return true;
+}
+
+/**
+ * Reads the status line, the headers and the body (an error message, if any), which is skipped.
+ * @param keepAlive Set if the connection can carry the next request.
+ * @return The HTTP status code, or -1 if no valid response arrived in time.
+ */
+int InfluxHttpStream::readResponse(bool& keepAlive) {
+    keepAlive = false;
+    unsigned long deadline = millis() + INFLUX_STREAM_TIMEOUT_MS;
+    char line[128];
+    if (!readLine(line, sizeof(line), deadline) || strncmp(line, "HTTP/1.", 7) != 0) {
+        Log.errorln(F("[InfluxStream] No response from the server"));
+        return -1;
+    }
+    const char* space = strchr(line, ' ');
+    int code = space ? atoi(space + 1) : -1;
+
+    // HTTP/1.1 keeps the connection unless told otherwise, if the body length is known
+    bool close = strncmp(line, "HTTP/1.0", 8) == 0;
+    long contentLength = code == 204 || code == 304 ? 0 : -1;
+    bool complete = false;
+    while (readLine(line, sizeof(line), deadline)) {
+        if (line[0] == '\0') {
+            complete = true;
+            break;
+        }
+        if (strncasecmp(line, "Content-Length:", 15) == 0) {
+            contentLength = atol(line + 15);
+        } else if (strncasecmp(line, "Connection:", 11) == 0) {
+            const char* value = line + 11;
+            while (*value == ' ') value++;
+            if (strncasecmp(value, "close", 5) == 0) close = true;
+        } else if ((code == 429 || code == 503) && strncasecmp(line, "Retry-After:", 12) == 0) {
+            // InfluxDB throttling; Retry-After is in seconds
+            long seconds = atol(line + 12);
+            if (seconds > 0) {
+                retryAt = millis() + seconds * 1000UL;
+                throttled = true;
+            }
+        }
+    }
+    if (!complete || contentLength < 0) return code;
+
+    for (long skipped = 0; skipped < contentLength; skipped++) {
+        while (!client->available()) {
+            if (!client->connected() || static_cast<long>(millis() - deadline) >= 0) return code;
+            delay(1);
+        }
+        client->read();
+    }
+    keepAlive = !close;
+    return code;
+}
+
+void InfluxHttpStream::endRequest(bool success, size_t points, bool keepAlive) {
+    if (client != nullptr) {
+        connection.release(keepAlive);
+        client = nullptr;
+    }
+    uint32_t elapsed = millis() - startedAt;
+    stats.requests++;
+    stats.lastRequestMs = elapsed;
+    if (elapsed > stats.maxRequestMs) stats.maxRequestMs = elapsed;
+    if (success) {
+        stats.sentPoints += points;
+        stats.sentBytes += bodyBytes;
+        Log.notice(F("[InfluxStream] %u points, %u bytes sent in %u ms\n"), points, bodyBytes, elapsed);
+    } else {
+        stats.failedRequests++;
+    }
+}
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <Arduino.h>
+#include "settings.h"
+#include "HttpConnection.h"
+
+/**
+ * @brief Uploads readings to the InfluxDB v2 HTTP write API (/api/v2/write) in a single
+ * request of any size, streamed with chunked transfer encoding.
+ * Records are written one at a time into a chunk buffer of INFLUX_STREAM_CHUNK_SIZE bytes,
+ * which goes to the socket whenever it fills up: no batch body is built in RAM, so a
+ * request is bounded by the reading buffer rather than by contiguous heap.
+ * Unlike the sinks it runs synchronously in the caller's task; InfluxLogger::streamBacklog()
+ * feeds it from the reading buffer. The connection is kept open between requests while
+ * the server allows it, see HttpConnection.
+ *
+ * Usage: begin(), write() every record, then finish(); abort() on a write failure.
+ */
+class InfluxHttpStream {
+public:
+    struct Stats {
+        uint32_t requests = 0;
+        uint32_t failedRequests = 0;
+        uint32_t rejectedRequests = 0; // Refused for good by InfluxDB, included in failedRequests
+        uint32_t rejectedPoints = 0;
+        uint32_t sentPoints = 0;
+        uint64_t sentBytes = 0;     // Line protocol only, without the HTTP framing
+        uint32_t lastRequestMs = 0; // From connecting to the response
+        uint32_t maxRequestMs = 0;
+    };
+
+    /**
+     * @param serverUrl Base URL of the InfluxDB server, including scheme (e.g. https://host:8086).
+     * @param org InfluxDB organization.
+     * @param bucket InfluxDB bucket.
+     * @param token InfluxDB authentication token.
+     */
+    InfluxHttpStream(const char* serverUrl, const char* org, const char* bucket, const char* token)
+        : connection(serverUrl), org(org), bucket(bucket), token(token) {}
+
+    InfluxHttpStream(const InfluxHttpStream&) = delete;
+    InfluxHttpStream& operator=(const InfluxHttpStream&) = delete;
+
+    /**
+     * Connects and sends the request headers.
+     * @return false if the server could not be reached, or asked to wait (see retryInMs()).
+     */
+    bool begin();
+
+    /**
+     * Appends line protocol records to the request body.
+     * @return false if the connection failed; the request must then be aborted.
+     */
+    bool write(const char* data, size_t length);
+
+    /**
+     * Ends the body and waits for the response.
+     * @param points Number of records written, for the statistics.
+     * @return true if InfluxDB accepted the whole request.
+     */
+    bool finish(size_t points);
+
+    /**
+     * Whether InfluxDB refused the last request for good (see InfluxHttpSink::isRejection()):
+     * sending the same records again cannot succeed.
+     */
+    bool wasRejected() const { return rejected; }
+
+    /**
+     * Drops the request in progress.
+     */
+    void abort();
+
+    /**
+     * Time left before the delay asked by the server in its last throttling response
+     * (HTTP 429 or 503, Retry-After) has passed, 0 if none.
+     */
+    unsigned long retryInMs() const;
+
+    const Stats& getStats() const { return stats; }
+    const HttpConnection::Stats& getConnectionStats() const { return connection.getStats(); }
+    void logStats() const;
+
+private:
+    HttpConnection connection;
+    const char* org;
+    const char* bucket;
+    const char* token;
+    String requestPath;
+    WiFiClient* client = nullptr;
+
+    char chunk[INFLUX_STREAM_CHUNK_SIZE];
+    size_t chunkLength = 0;
+    size_t bodyBytes = 0;
+    unsigned long startedAt = 0;
+    unsigned long retryAt = 0;
+    bool throttled = false;
+    bool rejected = false;
+    Stats stats;
+
+    bool flushChunk();
+    bool writeRaw(const void* data, size_t length);
+    bool readLine(char* line, size_t size, unsigned long deadline);
+    int readResponse(bool& keepAlive);
+    void endRequest(bool success, size_t points, bool keepAlive);
+};
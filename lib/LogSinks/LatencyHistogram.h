@@ -0,0 +1,61 @@
+#pragma once
+
+#include <Arduino.h>
+
+/**
+ * @brief Fixed-size latency histogram with logarithmic buckets, for percentiles.
+ * Bucket i holds latencies up to 2^(i/4) ms (four buckets per doubling, about 19 %
+ * resolution), from 1 ms to about 55 s; slower ones fall in the last bucket, reported
+ * with the exact maximum. Fixed size, no allocation.
+ */
+class LatencyHistogram {
+public:
+    void record(uint32_t latencyMs) {
+        counts[bucketOf(latencyMs)]++;
+        total++;
+        if (latencyMs > maxMs) maxMs = latencyMs;
+    }
+
+    /**
+     * Upper bound of the bucket holding the given percentile.
+     * @param percentile 0 to 100.
+     * @return 0 if nothing was recorded.
+     */
+    uint32_t percentile(float percentile) const {
+        if (total == 0) return 0;
+        uint32_t rank = static_cast<uint32_t>(ceilf(total * percentile / 100.0f));
+        if (rank == 0) rank = 1;
+        uint32_t seen = 0;
+        for (uint8_t i = 0; i < BUCKETS; i++) {
+            seen += counts[i];
+            if (seen >= rank) {
+                if (i == BUCKETS - 1) return maxMs;
+                uint32_t bound = upperBound(i);
+                return bound < maxMs ? bound : maxMs;
+            }
+        }
+        return maxMs;
+    }
+
+    uint32_t count() const { return total; }
+    uint32_t max() const { return maxMs; }
+
+    void reset() { *this = LatencyHistogram(); }
+
+private:
+    static constexpr uint8_t BUCKETS = 64;
+
+    uint32_t counts[BUCKETS] = {};
+    uint32_t total = 0;
+    uint32_t maxMs = 0;
+
+    static uint32_t upperBound(uint8_t bucket) {
+        return static_cast<uint32_t>(ceilf(exp2f(bucket / 4.0f)));
+    }
+
+    static uint8_t bucketOf(uint32_t latencyMs) {
+        if (latencyMs <= 1) return 0;
+        uint8_t bucket = static_cast<uint8_t>(ceilf(4.0f * log2f(static_cast<float>(latencyMs))));
+        return bucket < BUCKETS ? bucket : BUCKETS - 1;
+    }
+};
@@ -0,0 +1,193 @@
+#include "LogSink.h"
+#include <ArduinoLog.h>
+#include <WiFi.h>
+
+LogSink::LogSink(const char* name, size_t queueDepth, uint32_t taskStackSize)
+    : sinkName(name), queueDepth(queueDepth), taskStackSize(taskStackSize),
+      backoff(LOG_SINK_BACKOFF_MIN_MS, LOG_SINK_BACKOFF_MAX_MS),
+      urgentBackoff(LOG_SINK_BACKOFF_MIN_MS, LOG_SINK_URGENT_BACKOFF_MAX_MS) {
+    queueMutex = xSemaphoreCreateMutex();
+}
+
+LogSink::~LogSink() {
+    if (task) vTaskDelete(task);
+    if (queueMutex) vSemaphoreDelete(queueMutex);
+}
+
+void LogSink::begin() {
+    if (task) {
+        Log.warningln(F("[%s] Sink already started."), sinkName);
+        return;
+    }
+    setup();
+    xTaskCreate(taskEntry, sinkName, taskStackSize, this, LOG_SINK_TASK_PRIORITY, &task);
+    Log.notice(F("[%s] Sink started" CR), sinkName);
+}
+
+bool LogSink::enqueue(const EncodedBatchPtr& batch) {
+    return push(queue, queueDepth, batch);
+}
+
+bool LogSink::enqueueUrgent(const EncodedBatchPtr& batch) {
+    return push(urgentQueue, LOG_SINK_URGENT_QUEUE_DEPTH, batch);
+}
+
+bool LogSink::push(std::deque<EncodedBatchPtr>& target, size_t depth, const EncodedBatchPtr& batch) {
+    bool dropped = false;
+    xSemaphoreTake(queueMutex, portMAX_DELAY);
+    if (target.size() >= depth) {
+        target.pop_front();
+        stats.droppedBatches++;
+        dropped = true;
+    }
+    target.push_back(batch);
+    xSemaphoreGive(queueMutex);
+
+    if (dropped) {
+        Log.warningln(F("[%s] Queue full, oldest batch dropped (%u dropped so far)."), sinkName, stats.droppedBatches);
+    }
+    if (task) xTaskNotifyGive(task);
+    return !dropped;
+}
+
+bool LogSink::hasUrgent() const {
+    xSemaphoreTake(queueMutex, portMAX_DELAY);
+    bool pending = !urgentQueue.empty();
+    xSemaphoreGive(queueMutex);
+    return pending;
+}
+
+size_t LogSink::queuedBatches() const {
+    xSemaphoreTake(queueMutex, portMAX_DELAY);
+    size_t count = queue.size();
+    xSemaphoreGive(queueMutex);
+    return count;
+}
+
+bool LogSink::isIdle() const {
+    xSemaphoreTake(queueMutex, portMAX_DELAY);
+    bool idle = queue.empty() && urgentQueue.empty() && state != State::SENDING;
+    xSemaphoreGive(queueMutex);
+    return idle;
+}
+
+LogSink::Stats LogSink::getStats() const {
+    xSemaphoreTake(queueMutex, portMAX_DELAY);
+    Stats copy = stats;
+    xSemaphoreGive(queueMutex);
+    return copy;
+}
+
+void LogSink::logStats() const {
+    Stats s = getStats();
+    Log.notice(F("[%s] sent %u batches (%u bytes), %u failed sends, %u dropped, %u rejected, last send %u ms\n"),
+               sinkName, s.sentBatches, static_cast<uint32_t>(s.sentBytes), s.failedSends, s.droppedBatches,
+               s.rejectedBatches, s.lastSendMs);
+    if (s.flushLatency.count() > 0) {
+        Log.notice(F("[%s] %u points, flush latency p50 %u ms p90 %u ms p99 %u ms max %u ms\n"),
+                   sinkName, s.sentPoints, s.flushLatency.percentile(50), s.flushLatency.percentile(90),
+                   s.flushLatency.percentile(99), s.flushLatency.max());
+    }
+    if (s.urgentSent > 0) {
+        Log.notice(F("[%s] %u alarms sent, end-to-end latency last %u ms avg %u ms max %u ms\n"),
+                   sinkName, s.urgentSent, s.lastUrgentLatencyMs,
+                   static_cast<uint32_t>(s.totalUrgentLatencyMs / s.urgentSent), s.maxUrgentLatencyMs);
+    }
+    if (requiresNetwork()) {
+        controller.logState(sinkName);
+    }
+}
+
+bool LogSink::networkAvailable() const {
+    return !requiresNetwork() || WiFi.status() == WL_CONNECTED;
+}
+
+void LogSink::processQueue() {
+    while (networkAvailable()) {
+        xSemaphoreTake(queueMutex, portMAX_DELAY);
+        // Each lane waits for its own backoff: failing bulk sends do not hold back alarms
+        unsigned long now = millis();
+        bool urgentDue = !urgentQueue.empty() && static_cast<long>(now - urgentRetryAt) >= 0;
+        bool bulkDue = !queue.empty() && static_cast<long>(now - retryAt) >= 0;
+        if (!urgentDue && !bulkDue) {
+            xSemaphoreGive(queueMutex);
+            return;
+        }
+        std::deque<EncodedBatchPtr>& source = urgentDue ? urgentQueue : queue;
+        // Keep the batch queued while sending, so it is retried if the send fails
+        EncodedBatchPtr batch = source.front();
+        state = State::SENDING;
+        xSemaphoreGive(queueMutex);
+
+        unsigned long start = millis();
+        retryAfterMs = 0;
+        rejected = false;
+        bool sent = send(*batch);
+        unsigned long elapsed = millis() - start;
+
+        Backoff& laneBackoff = batch->urgent ? urgentBackoff : backoff;
+        unsigned long retryDelayMs = 0;
+        uint32_t failureCount = 0; // Copied for the log lines below, which run without the mutex
+        xSemaphoreTake(queueMutex, portMAX_DELAY);
+        stats.lastSendMs = elapsed;
+        if (sent) {
+            // The batch may have been dropped meanwhile to make room for newer ones
+            if (!source.empty() && source.front() == batch) source.pop_front();
+            if (batch->urgent) {
+                uint32_t latency = millis() - batch->createdAt;
+                stats.urgentSent++;
+                stats.lastUrgentLatencyMs = latency;
+                stats.totalUrgentLatencyMs += latency;
+                if (latency > stats.maxUrgentLatencyMs) stats.maxUrgentLatencyMs = latency;
+            } else {
+                stats.flushLatency.record(millis() - batch->createdAt);
+            }
+            stats.sentBatches++;
+            stats.sentPoints += batch->points;
+            stats.sentBytes += batch->body.length();
+            stats.consecutiveFailures = 0;
+            laneBackoff.reset();
+            state = State::IDLE;
+        } else if (rejected) {
+            // The destination answered, so it is not backed off; the batch goes
+            if (!source.empty() && source.front() == batch) source.pop_front();
+            stats.rejectedBatches++;
+            failureCount = stats.rejectedBatches;
+            state = State::IDLE;
+        } else {
+            stats.failedSends++;
+            stats.consecutiveFailures++;
+            failureCount = stats.consecutiveFailures;
+            // The destination's own hint wins over a shorter backoff
+            retryDelayMs = max(laneBackoff.next(), retryAfterMs);
+            (batch->urgent ? urgentRetryAt : retryAt) = millis() + retryDelayMs;
+            state = State::BACKOFF;
+        }
+        xSemaphoreGive(queueMutex);
+
+        // Single-reading alarms would skew the batch tuning, and a rejection says nothing of the link
+        if (requiresNetwork() && !batch->urgent && !rejected) controller.recordSend(sent, elapsed, batch->points);
+
+        if (rejected) {
+            Log.errorln(F("[%s] %u points rejected by the destination, dropped (%u rejected batches so far)."),
+                        sinkName, batch->points, failureCount);
+            continue;
+        }
+        if (!sent) {
+            Log.warningln(F("[%s] %s send failed (%u in a row), retrying in %u ms."), sinkName,
+                          batch->urgent ? "Alarm" : "Batch", failureCount, retryDelayMs);
+            // The other lane may still be due
+            continue;
+        }
+        Log.verboseln(F("[%s] Sent %u points (%u bytes) in %u ms."), sinkName, batch->points, batch->body.length(), elapsed);
+    }
+}
+
+void LogSink::taskEntry(void* arg) {
+    LogSink* sink = static_cast<LogSink*>(arg);
+    for (;;) {
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(LOG_SINK_POLL_INTERVAL_MS));
+        sink->poll();
+        sink->processQueue();
+    }
+}
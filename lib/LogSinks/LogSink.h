@@ -0,0 +1,163 @@
+#pragma once
+
+#include <Arduino.h>
+#include <deque>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
+#include "settings.h"
+#include "EncodedBatch.h"
+#include "Backoff.h"
+#include "AdaptiveBatchController.h"
+#include "LatencyHistogram.h"
+
+/**
+ * @brief Base class for the destinations of encoded batches.
+ * Every sink owns a bounded queue and a task draining it, so a slow or failing
+ * sink never delays the sampling loop or the other sinks.
+ * When the queue is full the oldest batch is dropped (backpressure); after a
+ * failed send the sink backs off exponentially, with jitter, before retrying.
+ * Urgent batches have a separate queue which is always drained first, with its own,
+ * shorter backoff: failures of the bulk batches do not delay alarms, and retried alarms
+ * do not cut the bulk backoff short.
+ */
+class LogSink {
+public:
+    enum class State {
+        IDLE,
+        SENDING,
+        BACKOFF
+    };
+
+    struct Stats {
+        uint32_t sentBatches = 0;
+        uint32_t sentPoints = 0;
+        uint32_t failedSends = 0;
+        uint32_t droppedBatches = 0;
+        uint32_t rejectedBatches = 0; // Refused for good by the destination, dropped without retry
+        uint32_t consecutiveFailures = 0;
+        uint64_t sentBytes = 0;
+        uint32_t lastSendMs = 0;
+        // Priority lane, latency measured from the reading to the destination's ack
+        uint32_t urgentSent = 0;
+        uint32_t lastUrgentLatencyMs = 0;
+        uint32_t maxUrgentLatencyMs = 0;
+        uint64_t totalUrgentLatencyMs = 0;
+        // Flush latency of the bulk batches, from encoding to the destination's ack
+        LatencyHistogram flushLatency;
+    };
+
+    /**
+     * @param name Name of the sink, used for logging and as task name.
+     * @param queueDepth Maximum number of batches waiting to be sent.
+     * @param taskStackSize Stack size of the task draining the queue.
+     */
+    LogSink(const char* name, size_t queueDepth = LOG_SINK_QUEUE_DEPTH, uint32_t taskStackSize = LOG_SINK_TASK_STACK);
+
+    virtual ~LogSink();
+
+    LogSink(const LogSink&) = delete;
+    LogSink& operator=(const LogSink&) = delete;
+
+    /**
+     * Initializes the sink and starts its task.
+     */
+    void begin();
+
+    /**
+     * Queues a batch for sending. Never blocks.
+     * @return false if the oldest batch had to be dropped to make room.
+     */
+    bool enqueue(const EncodedBatchPtr& batch);
+
+    /**
+     * Queues an urgent batch on the priority lane, sent before any bulk batch
+     * and without waiting for a backoff of the bulk lane to expire. Never blocks.
+     * @return false if the oldest urgent batch had to be dropped to make room.
+     */
+    bool enqueueUrgent(const EncodedBatchPtr& batch);
+
+    /**
+     * @return true if urgent batches are waiting to be sent.
+     */
+    bool hasUrgent() const;
+
+    /**
+     * @return true if nothing is queued or being sent.
+     */
+    bool isIdle() const;
+
+    /**
+     * Sinks that need WiFi wait while the radio is off instead of failing.
+     */
+    virtual bool requiresNetwork() const { return true; }
+
+    /**
+     * @return Bulk batches queued, including the one being sent.
+     */
+    size_t queuedBatches() const;
+
+    /**
+     * Batch size and flush interval tuned from the sends of this sink, if it needs the network.
+     */
+    const AdaptiveBatchController& getController() const { return controller; }
+
+    const char* getName() const { return sinkName; }
+    State getState() const { return state; }
+    Stats getStats() const;
+    virtual void logStats() const;
+
+protected:
+    const char* sinkName;
+
+    /**
+     * Called once from begin(), before the task starts.
+     */
+    virtual void setup() {}
+
+    /**
+     * Delivers a batch. Runs in the sink task.
+     * @return true if the batch was accepted by the destination.
+     */
+    virtual bool send(const EncodedBatch& batch) = 0;
+
+    /**
+     * Called periodically from the sink task, e.g. to keep a connection alive.
+     */
+    virtual void poll() {}
+
+    /**
+     * Called from send() when the destination asks to slow down (e.g. HTTP 429 with
+     * Retry-After): the next attempt waits at least this long, even if the backoff is shorter.
+     */
+    void setRetryAfter(unsigned long delayMs) { retryAfterMs = delayMs; }
+
+    /**
+     * Called from send() when the destination refused the batch for good (e.g. HTTP 400 on
+     * malformed data), before returning false: the batch is dropped instead of retried, which
+     * would block the queue behind it forever.
+     */
+    void rejectBatch() { rejected = true; }
+
+private:
+    const size_t queueDepth;
+    const uint32_t taskStackSize;
+    std::deque<EncodedBatchPtr> queue;
+    std::deque<EncodedBatchPtr> urgentQueue;
+    SemaphoreHandle_t queueMutex = nullptr;
+    TaskHandle_t task = nullptr;
+    volatile State state = State::IDLE;
+    Backoff backoff;
+    unsigned long retryAt = 0;
+    Backoff urgentBackoff;
+    unsigned long urgentRetryAt = 0;
+    unsigned long retryAfterMs = 0;
+    bool rejected = false;
+    AdaptiveBatchController controller;
+    Stats stats;
+
+    void processQueue();
+    bool push(std::deque<EncodedBatchPtr>& target, size_t depth, const EncodedBatchPtr& batch);
+    bool networkAvailable() const;
+    static void taskEntry(void* arg);
+};
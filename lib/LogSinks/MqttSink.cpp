@@ -0,0 +1,32 @@
+#include "MqttSink.h"
+#include <ArduinoLog.h>
+
+void MqttSink::setup() {
+    mqtt.setServer(host, port);
+    Log.notice(F("[%s] Publishing to %s:%d on topic %s" CR), sinkName, host, port, topic);
+}
+
+bool MqttSink::ensureConnected() {
+    if (mqtt.connected()) return true;
+    if (WiFi.status() != WL_CONNECTED) return false;
+    if (!mqtt.connect(clientId, user, password)) {
+        Log.errorln(F("[%s] Connection to broker failed, state %d"), sinkName, mqtt.state());
+        return false;
+    }
+    Log.verboseln(F("[%s] Connected to broker"), sinkName);
+    return true;
+}
+
+bool MqttSink::send(const EncodedBatch& batch) {
+    if (!ensureConnected()) return false;
+
+    size_t length = batch.body.length();
+    if (!mqtt.beginPublish(topic, length, false)) return false;
+    size_t written = mqtt.write(reinterpret_cast<const uint8_t*>(batch.body.c_str()), length);
+    return mqtt.endPublish() && written == length;
+}
+
+void MqttSink::poll() {
+    // Keeps the session alive between batches
+    if (mqtt.connected()) mqtt.loop();
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <Arduino.h>
+#include <WiFi.h>
+#include <PubSubClient.h>
+#include "LogSink.h"
+
+/**
+ * @brief Publishes each batch as one line protocol message on an MQTT topic.
+ * Payloads are streamed with beginPublish()/endPublish(), so the batch is not
+ * copied into the client buffer and its size is not limited by MQTT_MAX_PACKET_SIZE.
+ */
+class MqttSink : public LogSink {
+public:
+    /**
+     * @param host Broker hostname or IP address.
+     * @param port Broker port.
+     * @param topic Topic the batches are published on.
+     * @param clientId MQTT client identifier, must be unique on the broker.
+     * @param user Optional username (nullptr for anonymous).
+     * @param password Optional password.
+     */
+    MqttSink(const char* host, uint16_t port, const char* topic, const char* clientId,
+             const char* user = nullptr, const char* password = nullptr)
+        : LogSink("Mqtt"), host(host), port(port), topic(topic), clientId(clientId),
+          user(user), password(password), mqtt(wifiClient) {}
+
+protected:
+    void setup() override;
+    bool send(const EncodedBatch& batch) override;
+    void poll() override;
+
+private:
+    const char* host;
+    const uint16_t port;
+    const char* topic;
+    const char* clientId;
+    const char* user;
+    const char* password;
+    WiFiClient wifiClient;
+    PubSubClient mqtt;
+
+    bool ensureConnected();
+};
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <Arduino.h>
+#include <ArduinoLog.h>
+#include <freertos/FreeRTOS.h>
+#include "LogSink.h"
+
+/**
+ * @brief Keeps the encoded batches in memory instead of sending them, for stress tests.
+ * Counts batches, points and bytes, measures the sustained points per second, keeps a
+ * copy of the last payload and a running FNV-1a hash of all payloads (to compare runs).
+ * An optional delay per batch emulates the latency of a real destination.
+ */
+class RecordingSink : public LogSink {
+public:
+    struct Recording {
+        uint32_t batches = 0;
+        uint32_t points = 0;
+        uint64_t bytes = 0;
+        size_t largestBatch = 0;     // bytes
+        uint32_t payloadHash = 2166136261u;
+        unsigned long firstBatchAt = 0;
+        unsigned long lastBatchAt = 0;
+    };
+
+    /**
+     * @param sendLatencyMs Time each send pretends to take.
+     */
+    explicit RecordingSink(unsigned long sendLatencyMs = 0) : LogSink("Recording"), sendLatencyMs(sendLatencyMs) {}
+
+    bool requiresNetwork() const override { return false; }
+
+    Recording getRecording() const {
+        portENTER_CRITICAL(&lock);
+        Recording copy = recording;
+        portEXIT_CRITICAL(&lock);
+        return copy;
+    }
+
+    /**
+     * Copy of the last payload received. Only for inspection: it allocates.
+     */
+    String getLastPayload() const {
+        xSemaphoreTake(payloadMutex, portMAX_DELAY);
+        String copy = lastPayload;
+        xSemaphoreGive(payloadMutex);
+        return copy;
+    }
+
+    /**
+     * Points per second between the first and the last batch.
+     */
+    float pointsPerSecond() const {
+        Recording r = getRecording();
+        unsigned long elapsed = r.lastBatchAt - r.firstBatchAt;
+        return elapsed > 0 ? r.points * 1000.0f / elapsed : 0.0f;
+    }
+
+    void logRecording() const {
+        Recording r = getRecording();
+        Log.notice(F("[Recording] %u batches, %u points, %u bytes (largest %u), %F points/s, hash %x\n"),
+                   r.batches, r.points, static_cast<uint32_t>(r.bytes), r.largestBatch, pointsPerSecond(), r.payloadHash);
+    }
+
+protected:
+    bool send(const EncodedBatch& batch) override {
+        if (sendLatencyMs > 0) delay(sendLatencyMs);
+
+        uint32_t hash;
+        portENTER_CRITICAL(&lock);
+        hash = recording.payloadHash;
+        portEXIT_CRITICAL(&lock);
+        const char* body = batch.body.c_str();
+        for (size_t i = 0; i < batch.body.length(); i++) {
+            hash ^= static_cast<uint8_t>(body[i]);
+            hash *= 16777619u;
+        }
+
+        xSemaphoreTake(payloadMutex, portMAX_DELAY);
+        lastPayload = batch.body;
+        xSemaphoreGive(payloadMutex);
+
+        unsigned long now = millis();
+        portENTER_CRITICAL(&lock);
+        if (recording.batches == 0) recording.firstBatchAt = batch.createdAt;
+        recording.lastBatchAt = now;
+        recording.batches++;
+        recording.points += batch.points;
+        recording.bytes += batch.body.length();
+        if (batch.body.length() > recording.largestBatch) recording.largestBatch = batch.body.length();
+        recording.payloadHash = hash;
+        portEXIT_CRITICAL(&lock);
+        return true;
+    }
+
+private:
+    const unsigned long sendLatencyMs;
+    Recording recording;
+    String lastPayload;
+    SemaphoreHandle_t payloadMutex = xSemaphoreCreateMutex();
+    mutable portMUX_TYPE lock = portMUX_INITIALIZER_UNLOCKED;
+};
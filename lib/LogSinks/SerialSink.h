@@ -0,0 +1,24 @@
+#pragma once
+
+#include <Arduino.h>
+#include "LogSink.h"
+
+/**
+ * @brief Writes batches as raw line protocol to a serial port (or any Print).
+ * Useful for a host-side collector reading the USB serial port.
+ */
+class SerialSink : public LogSink {
+public:
+    explicit SerialSink(Print& output = Serial) : LogSink("Serial"), output(output) {}
+
+    bool requiresNetwork() const override { return false; }
+
+protected:
+    bool send(const EncodedBatch& batch) override {
+        size_t written = output.write(reinterpret_cast<const uint8_t*>(batch.body.c_str()), batch.body.length());
+        return written == batch.body.length();
+    }
+
+private:
+    Print& output;
+};
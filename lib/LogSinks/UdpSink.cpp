@@ -0,0 +1,34 @@
+#include "UdpSink.h"
+#include <ArduinoLog.h>
+
+bool UdpSink::send(const EncodedBatch& batch) {
+    const char* body = batch.body.c_str();
+    size_t length = batch.body.length();
+    size_t start = 0;
+
+    while (start < length) {
+        // Extend the datagram record by record while it fits
+        size_t end = start;
+        while (end < length) {
+            const char* newline = static_cast<const char*>(memchr(body + end, '\n', length - end));
+            size_t next = newline ? (newline - body) + 1 : length;
+            if (next - start > UDP_SINK_MAX_DATAGRAM && end > start) break;
+            end = next;
+        }
+        if (end - start > UDP_SINK_MAX_DATAGRAM) {
+            Log.warningln(F("[%s] Record of %u bytes exceeds the datagram size, sending anyway."), sinkName, end - start);
+        }
+        if (!sendDatagram(body + start, end - start)) return false;
+        start = end;
+    }
+    return true;
+}
+
+bool UdpSink::sendDatagram(const char* data, size_t len) {
+    if (!udp.beginPacket(host, port)) {
+        Log.errorln(F("[%s] Cannot resolve %s"), sinkName, host);
+        return false;
+    }
+    udp.write(reinterpret_cast<const uint8_t*>(data), len);
+    return udp.endPacket() == 1;
+}
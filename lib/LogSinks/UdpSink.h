@@ -0,0 +1,25 @@
+#pragma once
+
+#include <Arduino.h>
+#include <WiFiUdp.h>
+#include "LogSink.h"
+
+/**
+ * @brief Sends batches as line protocol datagrams to a UDP collector
+ * (e.g. the Telegraf socket_listener or InfluxDB 1.x UDP input).
+ * Batches are split on record boundaries so that no datagram exceeds UDP_SINK_MAX_DATAGRAM.
+ */
+class UdpSink : public LogSink {
+public:
+    UdpSink(const char* host, uint16_t port) : LogSink("Udp"), host(host), port(port) {}
+
+protected:
+    bool send(const EncodedBatch& batch) override;
+
+private:
+    const char* host;
+    const uint16_t port;
+    WiFiUDP udp;
+
+    bool sendDatagram(const char* data, size_t len);
+};
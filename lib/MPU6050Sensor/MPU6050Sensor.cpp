@@ -1,13 +1,66 @@
 #include "MPU6050Sensor.h"
 #include <Arduino.h>
+#include <esp_sleep.h>
+#include <driver/gpio.h>
+#include <esp_timer.h>
 #include "../../include/SensorExceptions.h"
 
+// Resolution of the buffered fields: 0.005 m/s^2 covers +-16 g, 0.002 rad/s covers +-2000 deg/s
+static constexpr FieldSchema FIELD_SCHEMA[] = {
+    {"ax", 0.005f, 0.0f},
+    {"ay", 0.005f, 0.0f},
+    {"az", 0.005f, 0.0f},
+    {"gx", 0.002f, 0.0f},
+    {"gy", 0.002f, 0.0f},
+    {"gz", 0.002f, 0.0f},
+    {"temp", 0.01f, 0.0f},
+};
+
+// Orientation output: quaternion to 1e-4, angles to 0.01 deg
+static constexpr FieldSchema ORIENTATION_SCHEMA[] = {
+    {"qw", 0.0001f, 0.0f},
+    {"qx", 0.0001f, 0.0f},
+    {"qy", 0.0001f, 0.0f},
+    {"qz", 0.0001f, 0.0f},
+    {"roll", 0.01f, 0.0f},
+    {"pitch", 0.01f, 0.0f},
+    {"yaw", 0.01f, 0.0f},
+    {"tilt", 0.01f, 0.0f},
+    {"temp", 0.01f, 0.0f},
+    {"upd_hz", 0.1f, 0.0f},
+    {"fuse_us", 0.01f, 0.0f},
+    {"fuse_mx", 0.01f, 0.0f},
+};
+
+// Vibration output: dominant frequencies to 0.1 Hz, band energies kept as float
+static constexpr FieldSchema SPECTRUM_SCHEMA[] = {
+    {"x_dom", 0.1f, 0.0f},
+    {"y_dom", 0.1f, 0.0f},
+    {"z_dom", 0.1f, 0.0f},
+    {"fs_hz", 0.1f, 0.0f},
+    {"fft_us", 1.0f, 0.0f},
+};
+
+static constexpr float VIBRATION_BAND_EDGES[] = VIBRATION_BAND_EDGES_HZ;
+
+// Gaps longer than this (e.g. a recalibration) restart the filter from the accelerometer
+static constexpr float MAX_FUSION_DT = 0.1f;
+
 void MPU6050Sensor::begin() {
     const uint8_t max_attempts = 5;
     uint8_t attempts = 0;
 
+    if (bus != nullptr) {
+        bus->begin();
+    }
+
     while (attempts < max_attempts) {
-        if (!mpu.begin()) {
+        bool started;
+        {
+            I2cBus::Lock lock(bus);
+            started = mpu.begin(ADDRESS, bus != nullptr ? &bus->getWire() : &Wire);
+        }
+        if (!started) {
             attempts++;
             delay(10);
             continue;
@@ -20,8 +73,24 @@ void MPU6050Sensor::begin() {
         throw SensorInitializationException("MPU6050 initialization failed after multiple attempts");
     }
 
+    if (bus != nullptr) {
+        readScales();
+    }
     isInitialized = true;
-    calibrate();
+    startCalibration();
+    // update() does not watch for motion in SPECTRUM mode: a latched INT would never be cleared
+    if (interruptPin >= 0 && output != Output::SPECTRUM) {
+        configureMotionInterrupt();
+    }
+    if (output == Output::SPECTRUM) {
+        I2cBus::Lock lock(bus);
+        // Full accelerometer bandwidth at 1 kHz. The bus clock is left to the application:
+        // a window sampled slower than configured is measured and reported as such
+        mpu.setFilterBandwidth(MPU6050_BAND_260_HZ);
+        mpu.setSampleRateDivisor(0);
+        spectrum.reset(new VibrationSpectrum(VIBRATION_FFT_SIZE, VIBRATION_BAND_EDGES,
+                                             sizeof(VIBRATION_BAND_EDGES) / sizeof(VIBRATION_BAND_EDGES[0])));
+    }
     Log.notice(F("[MPU6050] Sensor initialized successfully after %d attempts" CR), attempts);
 }
 
@@ -30,29 +99,230 @@ void MPU6050Sensor::update() {
         throw SensorNotInitializedException();
     }
 
-    constexpr float threshold = 0.1f;
-    constexpr uint32_t durationMs = 2000;
-    static uint32_t thresholdStartTime = 0;
-    static bool thresholdExceeded = false;
+    // Calibration owns the sensor until it completes
+    if (calibration.resume()) {
+        return;
+    }
+
+    // A vibrating sensor is expected: recalibrating on motion would never end
+    if (output == Output::SPECTRUM) {
+        return;
+    }
+
+    bool thresholdExceeded = false;
+    if (output == Output::ORIENTATION || interruptPin < 0) {
+        // A failed read throws, so SensorManager can quarantine a dead sensor
+        Sample sample;
+        if (bus != nullptr) {
+            if (!takeBusSample(sample)) {
+                return; // No new sample yet
+            }
+        } else if (!readSample(sample)) {
+            throw SensorReadException("Failed to read sensor data in update()");
+        }
+        if (output == Output::ORIENTATION) {
+            fuse(sample);
+        }
+        if (interruptPin < 0) {
+            thresholdExceeded = exceedsThreshold(sample);
+        }
+    }
+    if (interruptPin >= 0) {
+        thresholdExceeded = interruptThresholdExceeded();
+    }
+
+    trackMotion(thresholdExceeded);
+}
+
+/**
+ * Read a full sample and apply the calibration offsets.
+ * Through the bus, the read waits behind the transactions already queued.
+ * @return false if the sensor could not be read.
+ */
+bool MPU6050Sensor::readSample(Sample& sample) {
+    if (bus != nullptr) {
+        uint8_t raw[SAMPLE_LENGTH];
+        if (!bus->readRegisters(ADDRESS, SAMPLE_REGISTER, raw, SAMPLE_LENGTH)) {
+            return false;
+        }
+        decodeSample(raw, esp_timer_get_time(), sample);
+        return true;
+    }
 
     sensors_event_t accel, gyro, temp;
     if (!mpu.getEvent(&accel, &gyro, &temp)) {
-        Log.warning(F("[MPU6050] Failed to read sensor data in update()" CR));
-        return;
+        return false;
+    }
+
+    sample.ax = accel.acceleration.x - ax_offset;
+    sample.ay = accel.acceleration.y - ay_offset;
+    sample.az = accel.acceleration.z - az_offset;
+    sample.gx = gyro.gyro.x - gx_offset;
+    sample.gy = gyro.gyro.y - gy_offset;
+    sample.gz = gyro.gyro.z - gz_offset;
+    sample.temp = temp.temperature;
+    sample.timeUs = esp_timer_get_time();
+    return true;
+}
+
+/**
+ * Collect the burst queued by the previous call, if it completed, and queue the next one.
+ * The loop never waits for the bus: each sample is processed one update() after it was
+ * requested, with the time it was actually read.
+ * @return true if a new sample is available.
+ * @throws SensorReadException if the completed burst failed; the next one is queued anyway.
+ */
+bool MPU6050Sensor::takeBusSample(Sample& sample) {
+    bool available = false;
+    bool failed = false;
+    if (burstState.load(std::memory_order_acquire) == BURST_DONE) {
+        available = collectBurst(sample);
+        failed = !available;
+    }
+
+    if (burstState.load(std::memory_order_relaxed) == BURST_IDLE) {
+        submitBurst(); // If the bus is saturated, retried on the next update()
+    }
+    if (failed) {
+        throw SensorReadException("Failed to read sensor data in update()");
+    }
+    return available;
+}
+
+/**
+ * Queue a read of the sample registers into the burst buffer, which must be idle.
+ * @return false if the bus queue is full.
+ */
+bool MPU6050Sensor::submitBurst() {
+    burstState.store(BURST_IN_FLIGHT, std::memory_order_relaxed);
+    I2cBus::Transaction read = {ADDRESS, SAMPLE_REGISTER, nullptr, 0, burst, SAMPLE_LENGTH, onBurstComplete, this};
+    if (!bus->submit(read)) {
+        burstState.store(BURST_IDLE, std::memory_order_relaxed);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Decode a completed burst and release the buffer.
+ * @return false if the read failed.
+ */
+bool MPU6050Sensor::collectBurst(Sample& sample) {
+    bool success = burstSucceeded;
+    if (success) {
+        decodeSample(burst, burstTimeUs, sample);
+    }
+    burstState.store(BURST_IDLE, std::memory_order_relaxed);
+    return success;
+}
+
+void MPU6050Sensor::onBurstComplete(void* context, bool success) {
+    MPU6050Sensor* self = static_cast<MPU6050Sensor*>(context);
+    self->burstTimeUs = esp_timer_get_time();
+    self->burstSucceeded = success;
+    self->burstState.store(BURST_DONE, std::memory_order_release);
+}
+
+/**
+ * Read the configured ranges once, to convert the raw registers without the Adafruit driver.
+ */
+void MPU6050Sensor::readScales() {
+    I2cBus::Lock lock(bus);
+    switch (mpu.getAccelerometerRange()) {
+        case MPU6050_RANGE_2_G: accelScale = 9.80665f / 16384.0f; break;
+        case MPU6050_RANGE_4_G: accelScale = 9.80665f / 8192.0f; break;
+        case MPU6050_RANGE_8_G: accelScale = 9.80665f / 4096.0f; break;
+        default: accelScale = 9.80665f / 2048.0f; break;
+    }
+    constexpr float degToRad = 0.017453293f;
+    switch (mpu.getGyroRange()) {
+        case MPU6050_RANGE_250_DEG: gyroScale = degToRad / 131.0f; break;
+        case MPU6050_RANGE_500_DEG: gyroScale = degToRad / 65.5f; break;
+        case MPU6050_RANGE_1000_DEG: gyroScale = degToRad / 32.8f; break;
+        default: gyroScale = degToRad / 16.4f; break;
     }
+}
+
+/**
+ * Convert the big-endian sample registers and apply the calibration offsets.
+ */
+void MPU6050Sensor::decodeSample(const uint8_t* raw, int64_t timeUs, Sample& sample) const {
+    auto word = [raw](uint8_t index) { return static_cast<int16_t>((raw[index] << 8) | raw[index + 1]); };
+
+    sample.ax = word(0) * accelScale - ax_offset;
+    sample.ay = word(2) * accelScale - ay_offset;
+    sample.az = word(4) * accelScale - az_offset;
+    sample.temp = word(6) / 340.0f + 36.53f;
+    sample.gx = word(8) * gyroScale - gx_offset;
+    sample.gy = word(10) * gyroScale - gy_offset;
+    sample.gz = word(12) * gyroScale - gz_offset;
+    sample.timeUs = timeUs;
+}
+
+/**
+ * Check whether any axis exceeds the motion threshold.
+ * Only used when no interrupt pin is configured.
+ */
+bool MPU6050Sensor::exceedsThreshold(const Sample& sample) const {
+    constexpr float threshold = 0.1f;
 
-    float ax = accel.acceleration.x - ax_offset;
-    float ay = accel.acceleration.y - ay_offset;
     // Subtract gravity (9.80665 m/s^2) from Z acceleration to account for Earth's gravity
-    float az = accel.acceleration.z - az_offset - 9.80665f;
+    float az = sample.az - 9.80665f;
+
+    return (fabs(sample.ax) > threshold) || (fabs(sample.ay) > threshold) || (fabs(az) > threshold) ||
+           (fabs(sample.gx) > threshold) || (fabs(sample.gy) > threshold) || (fabs(sample.gz) > threshold);
+}
+
+/**
+ * Advance the orientation filter with a sample and account for its CPU cost.
+ * The filter gets the gyro with its bias removed, but the accelerometer as measured: the
+ * accelerometer offsets are taken in the boot pose and would zero roll and pitch there.
+ */
+void MPU6050Sensor::fuse(const Sample& sample) {
+    int64_t now = esp_timer_get_time();
+    float dt = (sample.timeUs - lastFusionUs) * 1e-6f;
+    lastFusionUs = sample.timeUs;
+    lastTemp = sample.temp;
+
+    float ax = sample.ax + ax_offset;
+    float ay = sample.ay + ay_offset;
+    float az = sample.az + az_offset;
+    if (!filter.isInitialized() || dt > MAX_FUSION_DT) {
+        filter.reset(ax, ay, az);
+        // The rate is measured from the first sample of the run, not from boot or across a gap
+        if (fusionUpdates == 0) fusionWindowStartUs = now;
+        return;
+    }
+
+    filter.update(sample.gx, sample.gy, sample.gz, ax, ay, az, dt);
+
+    uint32_t elapsed = static_cast<uint32_t>(esp_timer_get_time() - now);
+    fusionUpdates++;
+    fusionCpuUs += elapsed;
+    if (elapsed > fusionMaxUs) fusionMaxUs = elapsed;
+}
+
+/**
+ * Consume the motion interrupt signalled by the ISR, if any.
+ * The bus is only touched when an interrupt is pending, to release the latched INT line.
+ * While motion persists the sensor keeps raising the interrupt, so motion is considered
+ * ongoing until no event has been seen for MPU6050_MOTION_EVENT_GAP_MS.
+ */
+bool MPU6050Sensor::interruptThresholdExceeded() {
+    uint32_t now = millis();
 
-    float gx = gyro.gyro.x - gx_offset;
-    float gy = gyro.gyro.y - gy_offset;
-    float gz = gyro.gyro.z - gz_offset;
+    if (motionPending) {
+        motionPending = false;
+        I2cBus::Lock lock(bus);
+        mpu.getMotionInterruptStatus(); // Reading INT_STATUS clears the latched interrupt
+        lastMotionEventTime = now;
+    }
 
-    // Check if any axis exceeds the threshold
-    thresholdExceeded = (fabs(ax) > threshold) || (fabs(ay) > threshold) || (fabs(az) > threshold) ||
-                        (fabs(gx) > threshold) || (fabs(gy) > threshold) || (fabs(gz) > threshold);
+    return lastMotionEventTime != 0 && now - lastMotionEventTime <= MPU6050_MOTION_EVENT_GAP_MS;
+}
+
+void MPU6050Sensor::trackMotion(bool thresholdExceeded) {
+    constexpr uint32_t durationMs = 2000;
 
     if(!thresholdExceeded) {
         thresholdStartTime = 0;
@@ -69,10 +339,37 @@ void MPU6050Sensor::update() {
 
     // If we reach here, it means the threshold was exceeded for the specified duration
     Log.notice(F("[MPU6050] Axis exceeded threshold for %d ms, starting auto-calibration" CR), durationMs);
-    calibrate();
+    startCalibration();
 
-    thresholdExceeded = false;
     thresholdStartTime = 0;
+    lastMotionEventTime = 0;
+    motionPending = false;
+}
+
+/**
+ * Enable the MPU6050 motion detection interrupt and attach the ISR to the configured pin.
+ * The INT line is configured active low and latched until INT_STATUS is read.
+ */
+void MPU6050Sensor::configureMotionInterrupt() {
+    {
+        I2cBus::Lock lock(bus);
+        mpu.setHighPassFilter(MPU6050_HIGHPASS_0_63_HZ);
+        mpu.setMotionDetectionThreshold(MPU6050_MOTION_THRESHOLD);
+        mpu.setMotionDetectionDuration(MPU6050_MOTION_DURATION);
+        mpu.setInterruptPinLatch(true);
+        mpu.setInterruptPinPolarity(true);
+        mpu.setMotionInterrupt(true);
+    }
+
+    pinMode(interruptPin, INPUT_PULLUP);
+    // Edge triggered: the line stays low until loop() reads INT_STATUS. The light sleep
+    // wakeup on this pin is armed by SensorManager around the sleep only, see wakeupPin()
+    attachInterruptArg(digitalPinToInterrupt(interruptPin), onMotionInterrupt, this, FALLING);
+    Log.notice(F("[MPU6050] Motion interrupt enabled on pin %d" CR), interruptPin);
+}
+
+void IRAM_ATTR MPU6050Sensor::onMotionInterrupt(void* arg) {
+    static_cast<MPU6050Sensor*>(arg)->motionPending = true;
 }
 
 SensorResult MPU6050Sensor::readValues(bool force, bool updateReadTime) {
@@ -84,77 +381,225 @@ SensorResult MPU6050Sensor::readValues(bool force, bool updateReadTime) {
         return SensorResult(getSensorName());
     }
 
+    // No data until the offsets are known
+    if (calibration.isRunning()) {
+        return SensorResult(getSensorName());
+    }
+
     if (updateReadTime)
         lastReadTime = millis();
 
-    sensors_event_t accel, gyro, temp;
+    SensorResult result(this->getSensorName());
 
-    if (!mpu.getEvent(&accel, &gyro, &temp)) {
+    if (output == Output::ORIENTATION) {
+        setOrientationValues(result);
+        return result;
+    }
+    if (output == Output::SPECTRUM) {
+        setSpectrumValues(result);
+        return result;
+    }
+
+    Sample sample;
+    if (!readSample(sample)) {
         throw SensorReadException("Failed to read sensor data");
     }
 
-    SensorResult result(this->getSensorName());
-    
-    float ax = accel.acceleration.x - ax_offset;
-    float ay = accel.acceleration.y - ay_offset;
-    float az = accel.acceleration.z - az_offset;
-    float gx = gyro.gyro.x - gx_offset;
-    float gy = gyro.gyro.y - gy_offset;
-    float gz = gyro.gyro.z - gz_offset;
-    
     // Popola i valori dell'accelerometro
-    result.set("ax", ax);
-    result.set("ay", ay);
-    result.set("az", az);
+    result.set("ax", sample.ax);
+    result.set("ay", sample.ay);
+    result.set("az", sample.az);
 
     // Popola i valori del giroscopio
-    result.set("gx", gx);
-    result.set("gy", gy);
-    result.set("gz", gz);
+    result.set("gx", sample.gx);
+    result.set("gy", sample.gy);
+    result.set("gz", sample.gz);
 
     // Popola la temperatura
-    result.set("temp", temp.temperature);
+    result.set("temp", sample.temp);
 
     return result;
 }
 
 /**
- * Calibrate the MPU6050 sensor.
- * Calculate and apply offsets for accelerometer and gyroscope.
- * This method assumes the sensor is stationary during calibration.
+ * Publish the current orientation, the update rate and the average and worst
+ * CPU time of a filter update since the previous result.
+ * Without a sample fused since the previous result (no update() yet, or update() not run
+ * while quarantined) the sensor is read here, so a stale orientation is never published.
+ * @throws SensorReadException if that read fails.
+ */
+void MPU6050Sensor::setOrientationValues(SensorResult& result) {
+    if (!filter.isInitialized() || lastFusionUs == reportedFusionUs) {
+        // Starts from the gravity direction if the filter has no recent state
+        Sample sample;
+        if (!readSample(sample)) {
+            throw SensorReadException("Failed to read sensor data");
+        }
+        fuse(sample);
+    }
+    reportedFusionUs = lastFusionUs;
+
+    MadgwickFilter::Euler euler = filter.getEuler();
+    result.set("qw", filter.qw());
+    result.set("qx", filter.qx());
+    result.set("qy", filter.qy());
+    result.set("qz", filter.qz());
+    result.set("roll", euler.roll);
+    result.set("pitch", euler.pitch);
+    result.set("yaw", euler.yaw);
+    result.set("tilt", filter.getTilt());
+    result.set("temp", lastTemp);
+
+    int64_t now = esp_timer_get_time();
+    if (fusionUpdates > 0) {
+        result.set("upd_hz", fusionUpdates * 1e6f / (now - fusionWindowStartUs));
+        result.set("fuse_us", static_cast<float>(fusionCpuUs) / fusionUpdates);
+        result.set("fuse_mx", fusionMaxUs);
+    }
+    fusionWindowStartUs = now;
+    fusionUpdates = 0;
+    fusionCpuUs = 0;
+    fusionMaxUs = 0;
+}
+
+/**
+ * Capture a vibration window and publish its spectrum.
+ * The window is sampled in a paced busy loop, so the call blocks for about
+ * VIBRATION_FFT_SIZE / VIBRATION_SAMPLE_RATE_HZ seconds. The rate actually achieved
+ * is measured and used for the frequency axis, in case the bus could not keep up.
+ */
+void MPU6050Sensor::setSpectrumValues(SensorResult& result) {
+    const int64_t periodUs = 1000000LL / VIBRATION_SAMPLE_RATE_HZ;
+
+    spectrum->reset();
+    int64_t firstUs = esp_timer_get_time();
+    int64_t nextUs = firstUs;
+    int64_t lastUs = firstUs;
+    while (!spectrum->isFull()) {
+        while (esp_timer_get_time() < nextUs) {}
+        lastUs = esp_timer_get_time();
+        Sample sample;
+        if (!readSample(sample)) {
+            throw SensorReadException("Failed to read sensor data");
+        }
+        spectrum->addSample(sample.ax, sample.ay, sample.az);
+        nextUs += periodUs;
+    }
+
+    float sampleRateHz = (VIBRATION_FFT_SIZE - 1) * 1e6f / (lastUs - firstUs);
+    uint32_t fftUs = spectrum->analyze(sampleRateHz, result);
+    result.set("fs_hz", sampleRateHz);
+    result.set("fft_us", fftUs);
+    Log.verboseln(F("[MPU6050] Spectrum of %d samples at %F Hz computed in %u us"), VIBRATION_FFT_SIZE, sampleRateHz, fftUs);
+}
+
+/**
+ * Start calibrating the MPU6050 sensor: offsets for the accelerometer and gyroscope are
+ * measured by the calibration task, resumed on every update().
+ * This method assumes the sensor stays stationary until the calibration completes.
  */
-void MPU6050Sensor::calibrate() {
+void MPU6050Sensor::startCalibration() {
     if (!isInitialized) {
         throw SensorNotInitializedException();
     }
 
-    constexpr size_t samples = 1000;
-    constexpr uint16_t delayMs = 2;
+    Log.notice(F("[MPU6050] Starting calibration with %d samples" CR), Calibration::SAMPLES);
+    calibration.start();
+}
 
-    Log.notice(F("[MPU6050] Starting calibration with %d samples" CR), samples);
+void MPU6050Sensor::Calibration::run() {
+    CO_BEGIN();
 
-    for (size_t i = 0; i < samples; ++i) {
-        sensors_event_t accel, gyro, temp;
-        if (!mpu.getEvent(&accel, &gyro, &temp)) {
-            Log.warning(F("[MPU6050] Failed to read sensor data during calibration at sample %d" CR), i);
-            continue;
+    // Samples are read raw, and offsets from a previous calibration must not accumulate
+    previous[0] = sensor.ax_offset;
+    previous[1] = sensor.ay_offset;
+    previous[2] = sensor.az_offset;
+    previous[3] = sensor.gx_offset;
+    previous[4] = sensor.gy_offset;
+    previous[5] = sensor.gz_offset;
+    sensor.ax_offset = sensor.ay_offset = sensor.az_offset = 0.0f;
+    sensor.gx_offset = sensor.gy_offset = sensor.gz_offset = 0.0f;
+    for (BlockStats& axis : axes) {
+        axis.reset();
+    }
+    blockLength = 0;
+
+    if (sensor.bus != nullptr) {
+        // A burst queued by update() was read with the old offsets: drop it
+        CO_AWAIT(sensor.burstState.load(std::memory_order_acquire) != BURST_IN_FLIGHT);
+        sensor.burstState.store(BURST_IDLE, std::memory_order_relaxed);
+    }
+
+    for (taken = 0; taken < SAMPLES; taken++) {
+        if (sensor.bus != nullptr) {
+            sampleRead = sensor.submitBurst();
+            if (sampleRead) {
+                CO_AWAIT(sensor.burstState.load(std::memory_order_acquire) == BURST_DONE);
+                sampleRead = sensor.collectBurst(sample);
+            }
+        } else {
+            sampleRead = sensor.readSample(sample);
         }
-        ax_offset += accel.acceleration.x;
-        ay_offset += accel.acceleration.y;
-        az_offset += accel.acceleration.z;
-        gx_offset += gyro.gyro.x;
-        gy_offset += gyro.gyro.y;
-        gz_offset += gyro.gyro.z;
-        delay(delayMs);
-    }
-
-    ax_offset /= samples;
-    ay_offset /= samples;
-    az_offset = (az_offset / samples) - 9.80665f; // Remove gravity (m/s^2)
-    gx_offset /= samples;
-    gy_offset /= samples;
-    gz_offset /= samples;
+
+        if (!sampleRead) {
+            Log.warning(F("[MPU6050] Failed to read sensor data during calibration at sample %d" CR), taken);
+        } else {
+            block[0][blockLength] = sample.ax;
+            block[1][blockLength] = sample.ay;
+            block[2][blockLength] = sample.az;
+            block[3][blockLength] = sample.gx;
+            block[4][blockLength] = sample.gy;
+            block[5][blockLength] = sample.gz;
+            if (++blockLength == BLOCK_SIZE) {
+                flushBlock();
+            }
+        }
+        CO_SLEEP_MS(PERIOD_MS);
+    }
+    flushBlock();
+    finish();
+
+    CO_END();
+}
+
+void MPU6050Sensor::Calibration::flushBlock() {
+    for (uint8_t axis = 0; axis < 6; axis++) {
+        axes[axis].add(block[axis], blockLength);
+    }
+    blockLength = 0;
+}
+
+void MPU6050Sensor::Calibration::finish() {
+    if (axes[0].count() == 0) {
+        sensor.ax_offset = previous[0];
+        sensor.ay_offset = previous[1];
+        sensor.az_offset = previous[2];
+        sensor.gx_offset = previous[3];
+        sensor.gy_offset = previous[4];
+        sensor.gz_offset = previous[5];
+        Log.error(F("[MPU6050] Calibration failed, no sample could be read; offsets unchanged" CR));
+        return;
+    }
+    sensor.ax_offset = axes[0].mean();
+    sensor.ay_offset = axes[1].mean();
+    sensor.az_offset = axes[2].mean() - 9.80665f; // Remove gravity (m/s^2)
+    sensor.gx_offset = axes[3].mean();
+    sensor.gy_offset = axes[4].mean();
+    sensor.gz_offset = axes[5].mean();
 
     Log.notice(F("[MPU6050] Calibration complete. Offsets: ax=%F ay=%F az=%F gx=%F gy=%F gz=%F" CR),
-               ax_offset, ay_offset, az_offset, gx_offset, gy_offset, gz_offset);
-}
\ No newline at end of file
+               sensor.ax_offset, sensor.ay_offset, sensor.az_offset, sensor.gx_offset, sensor.gy_offset, sensor.gz_offset);
+}
+
+const FieldSchema* MPU6050Sensor::getFieldSchema(uint8_t& count) const {
+    if (output == Output::ORIENTATION) {
+        count = sizeof(ORIENTATION_SCHEMA) / sizeof(ORIENTATION_SCHEMA[0]);
+        return ORIENTATION_SCHEMA;
+    }
+    if (output == Output::SPECTRUM) {
+        count = sizeof(SPECTRUM_SCHEMA) / sizeof(SPECTRUM_SCHEMA[0]);
+        return SPECTRUM_SCHEMA;
+    }
+    count = sizeof(FIELD_SCHEMA) / sizeof(FIELD_SCHEMA[0]);
+    return FIELD_SCHEMA;
+}
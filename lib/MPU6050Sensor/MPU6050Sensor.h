@@ -4,27 +4,186 @@
 #include <Adafruit_MPU6050.h>
 #include <Adafruit_Sensor.h>
 #include <Wire.h>
+#include <atomic>
+#include <memory>
 #include "../../include/ISensor.h"
 #include "../../include/ResultCode.h"
 #include "SensorResult.h"
+#include "I2cBus.h"
+#include "CoTask.h"
+#include "BlockStats.h"
+#include "MadgwickFilter.h"
+#include "VibrationSpectrum.h"
 
 class MPU6050Sensor : public ISensor {
 
     public:
-        
+
+    /**
+     * What readValues() publishes.
+     */
+    enum class Output : uint8_t {
+        RAW,        // Offset-corrected accelerometer and gyroscope
+        ORIENTATION, // Quaternion, Euler angles and tilt, fused on every update()
+        SPECTRUM     // Vibration band energies and dominant frequency per axis
+    };
+
     void begin() override;
     void update() override;
     SensorResult readValues(bool force = false, bool updateReadTime = true) override;
-    MPU6050Sensor(const char* sensorName, unsigned long interval = 200) : ISensor(sensorName, interval) {}
+    const FieldSchema* getFieldSchema(uint8_t& count) const override;
+
+    /**
+     * Polling motion detection and orientation fusion need every loop iteration. With the
+     * interrupt the device may sleep, except while a motion episode is being tracked.
+     * The vibration spectrum is sampled by readValues() alone.
+     */
+    bool requiresContinuousSampling() const override {
+        if (calibration.isRunning()) return true;
+        if (output == Output::SPECTRUM) return false;
+        return output == Output::ORIENTATION || interruptPin < 0 || motionPending || thresholdStartTime != 0;
+    }
+
+    /**
+     * The latched INT line, once configured: motion wakes the device from light sleep.
+     * Not in SPECTRUM mode, which leaves the motion interrupt off.
+     */
+    int8_t wakeupPin() const override {
+        return isInitialized && output != Output::SPECTRUM ? interruptPin : -1;
+    }
+
+    /**
+     * A spectrum read captures a whole window, plus the FFT.
+     */
+    uint32_t readTimeBudgetUs() const override {
+        if (output == Output::SPECTRUM) return 2ULL * VIBRATION_FFT_SIZE * 1000000ULL / VIBRATION_SAMPLE_RATE_HZ;
+        return ISensor::readTimeBudgetUs();
+    }
+
+    /**
+     * @param sensorName Name of the sensor.
+     * @param interval Update interval in ms (default: 200 ms).
+     * @param interruptPin GPIO wired to the MPU6050 INT pin. When set, motion is detected by the
+     *                     sensor itself and update() only reacts to the interrupt instead of polling
+     *                     the bus on every loop. Use -1 (default) to keep polling. Unused in SPECTRUM mode.
+     * @param output RAW (default) publishes the motion data; ORIENTATION samples the sensor on
+     *               every update() to run the fusion filter and publishes only the orientation;
+     *               SPECTRUM captures a window of VIBRATION_FFT_SIZE samples at
+     *               VIBRATION_SAMPLE_RATE_HZ on every read and publishes its spectrum.
+     * @param bus Shared bus to read the sensor through. update() then queues the sample read
+     *            and processes it on the next call instead of waiting for the bus; nullptr
+     *            (default) reads synchronously through the Adafruit driver on Wire.
+     */
+    MPU6050Sensor(const char* sensorName, unsigned long interval = 200, int8_t interruptPin = -1,
+                  Output output = Output::RAW, I2cBus* bus = nullptr)
+        : ISensor(sensorName, interval), interruptPin(interruptPin), output(output), filter(MPU6050_FUSION_BETA), bus(bus) {}
     ~MPU6050Sensor() override = default;
 
+    /**
+     * Whether offsets are being measured; readValues() returns no data meanwhile.
+     */
+    bool isCalibrating() const { return calibration.isRunning(); }
+
     private:
+        /**
+         * Offset-corrected sample, gravity included in az.
+         */
+        struct Sample {
+            float ax, ay, az;
+            float gx, gy, gz;
+            float temp;
+            int64_t timeUs; // When it was read
+        };
+
+        // Sample registers, ACCEL_XOUT_H to GYRO_ZOUT_L, read in one burst
+        static constexpr uint8_t ADDRESS = 0x68;
+        static constexpr uint8_t SAMPLE_REGISTER = 0x3B;
+        static constexpr uint8_t SAMPLE_LENGTH = 14;
+
+        enum BurstState : uint8_t { BURST_IDLE, BURST_IN_FLIGHT, BURST_DONE };
+
+        /**
+         * Averages SAMPLES samples of the stationary sensor into the offsets,
+         * one sample per resume, sleeping between samples instead of blocking the loop.
+         */
+        class Calibration : public CoTask {
+        public:
+            static constexpr size_t SAMPLES = 1000;
+            static constexpr uint16_t PERIOD_MS = 2;
+            static constexpr size_t BLOCK_SIZE = 50; // Each axis is buffered and reduced a block at a time
+
+            explicit Calibration(MPU6050Sensor& sensor) : sensor(sensor) {}
+
+        protected:
+            void run() override;
+
+        private:
+            MPU6050Sensor& sensor;
+            size_t taken = 0;
+            size_t blockLength = 0;
+            bool sampleRead = false;
+            Sample sample;
+            float previous[6];
+            alignas(16) float block[6][BLOCK_SIZE];
+            BlockStats axes[6];
+
+            void flushBlock();
+            void finish();
+        };
+
         Adafruit_MPU6050 mpu;
         bool isInitialized = false;
 
         float ax_offset = 0.0f, ay_offset = 0.0f, az_offset = 0.0f;
         float gx_offset = 0.0f, gy_offset = 0.0f, gz_offset = 0.0f;
 
-        void calibrate();
+        // Motion detection state
+        const int8_t interruptPin;
+        volatile bool motionPending = false;
+        uint32_t lastMotionEventTime = 0;
+        uint32_t thresholdStartTime = 0;
+
+        // Orientation fusion state
+        const Output output;
+        MadgwickFilter filter;
+        int64_t lastFusionUs = 0;
+        int64_t reportedFusionUs = 0; // Time of the last sample fused into a published result
+        float lastTemp = NAN;
+        uint32_t fusionUpdates = 0;  // Since the last published result
+        uint64_t fusionCpuUs = 0;
+        uint32_t fusionMaxUs = 0;
+        int64_t fusionWindowStartUs = 0; // Set by the first fuse(), then by each published result
+
+        // Vibration analysis, allocated in begin() in SPECTRUM mode only
+        std::unique_ptr<VibrationSpectrum> spectrum;
+
+        // Bus reads: raw to SI scales, and the burst queued by update()
+        I2cBus* const bus;
+        float accelScale = 0.0f; // m/s^2 per LSB
+        float gyroScale = 0.0f;  // rad/s per LSB
+        uint8_t burst[SAMPLE_LENGTH];
+        std::atomic<uint8_t> burstState{BURST_IDLE};
+        volatile bool burstSucceeded = false;
+        volatile int64_t burstTimeUs = 0;
+
+        Calibration calibration{*this};
+
+        void startCalibration();
+        bool readSample(Sample& sample);
+        bool takeBusSample(Sample& sample);
+        bool submitBurst();
+        bool collectBurst(Sample& sample);
+        void readScales();
+        void decodeSample(const uint8_t* raw, int64_t timeUs, Sample& sample) const;
+        bool exceedsThreshold(const Sample& sample) const;
+        void fuse(const Sample& sample);
+        void setOrientationValues(SensorResult& result);
+        void setSpectrumValues(SensorResult& result);
+        void configureMotionInterrupt();
+        bool interruptThresholdExceeded();
+        void trackMotion(bool thresholdExceeded);
+
+        static void IRAM_ATTR onMotionInterrupt(void* arg);
+        static void onBurstComplete(void* context, bool success);
         
-};
\ No newline at end of file
+};
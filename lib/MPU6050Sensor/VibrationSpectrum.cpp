@@ -0,0 +1,79 @@
+#include "VibrationSpectrum.h"
+#include <esp_timer.h>
+
+VibrationSpectrum::VibrationSpectrum(size_t size, const float* bandEdgesHz, uint8_t bandEdgeCount)
+    : fft(size), bandEdges(bandEdgesHz), bandEdgeCount(bandEdgeCount > 11 ? 11 : bandEdgeCount) {
+    for (uint8_t a = 0; a < AXES; a++) {
+        samples[a] = new float[size];
+    }
+}
+
+VibrationSpectrum::~VibrationSpectrum() {
+    for (uint8_t a = 0; a < AXES; a++) {
+        delete[] samples[a];
+    }
+}
+
+bool VibrationSpectrum::addSample(float ax, float ay, float az) {
+    if (isFull()) return false;
+    samples[0][count] = ax;
+    samples[1][count] = ay;
+    samples[2][count] = az;
+    count++;
+    return true;
+}
+
+uint32_t VibrationSpectrum::analyze(float sampleRateHz, SensorResult& result) {
+    if (!isFull()) return 0;
+
+    static const char axisNames[AXES] = {'x', 'y', 'z'};
+    int64_t start = esp_timer_get_time();
+    for (uint8_t a = 0; a < AXES; a++) {
+        analyzeAxis(samples[a], axisNames[a], sampleRateHz, result);
+    }
+    count = 0;
+    return static_cast<uint32_t>(esp_timer_get_time() - start);
+}
+
+void VibrationSpectrum::analyzeAxis(float* data, char axis, float sampleRateHz, SensorResult& result) const {
+    fft.applyWindow(data);
+    fft.forward(data);
+
+    const size_t bins = fft.size() / 2;
+    const float binHz = sampleRateHz / fft.size();
+    char key[8];
+
+    // Dominant frequency, refined by fitting a parabola through the peak and its neighbours
+    size_t peak = 1;
+    float peakPower = fft.binPower(data, 1);
+    for (size_t k = 2; k <= bins; k++) {
+        float power = fft.binPower(data, k);
+        if (power > peakPower) {
+            peakPower = power;
+            peak = k;
+        }
+    }
+    float offset = 0.0f;
+    if (peak > 1 && peak < bins) {
+        float left = fft.binPower(data, peak - 1);
+        float right = fft.binPower(data, peak + 1);
+        float denominator = left - 2.0f * peakPower + right;
+        if (denominator != 0.0f) offset = 0.5f * (left - right) / denominator;
+    }
+    snprintf(key, sizeof(key), "%c_dom", axis);
+    result.set(key, (peak + offset) * binHz);
+
+    // Band energies
+    for (uint8_t band = 0; band + 1 < bandEdgeCount; band++) {
+        size_t first = static_cast<size_t>(ceilf(bandEdges[band] / binHz));
+        size_t last = static_cast<size_t>(ceilf(bandEdges[band + 1] / binHz));
+        if (first < 1) first = 1; // The mean was removed, DC only holds window leakage
+        if (last > bins + 1) last = bins + 1;
+        float energy = 0.0f;
+        for (size_t k = first; k < last; k++) {
+            energy += fft.binPower(data, k);
+        }
+        snprintf(key, sizeof(key), "%c_b%u", axis, static_cast<unsigned>(band));
+        result.set(key, energy);
+    }
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <Arduino.h>
+#include "SensorResult.h"
+#include "RealFft.h"
+
+/**
+ * @brief Band energies and dominant frequency of a 3 axis vibration window.
+ * Samples are collected into one fixed-size window per axis; analyze() runs the real FFT
+ * in place on each window and publishes, for each axis a in {x, y, z}:
+ *   a_dom  dominant frequency in Hz (interpolated between bins, DC excluded)
+ *   a_bI   mean square acceleration in band I, in (m/s^2)^2, with bands delimited by
+ *          consecutive entries of the band edges
+ */
+class VibrationSpectrum {
+public:
+    /**
+     * @param size Window length, a power of two.
+     * @param bandEdgesHz Increasing band edges; bands are [edge[i], edge[i+1]).
+     * @param bandEdgeCount Number of edges, at most 11 (10 bands).
+     */
+    VibrationSpectrum(size_t size, const float* bandEdgesHz, uint8_t bandEdgeCount);
+    ~VibrationSpectrum();
+
+    VibrationSpectrum(const VibrationSpectrum&) = delete;
+    VibrationSpectrum& operator=(const VibrationSpectrum&) = delete;
+
+    void reset() { count = 0; }
+
+    /**
+     * Appends a sample to the window.
+     * @return false once the window is full.
+     */
+    bool addSample(float ax, float ay, float az);
+
+    bool isFull() const { return count == fft.size(); }
+
+    /**
+     * Transforms the full window, writes the fields into result and empties the window.
+     * @param sampleRateHz Rate at which the window was actually captured.
+     * @return Time spent in the FFT and band integration, in microseconds.
+     */
+    uint32_t analyze(float sampleRateHz, SensorResult& result);
+
+private:
+    static constexpr uint8_t AXES = 3;
+
+    RealFft fft;
+    float* samples[AXES];
+    const float* bandEdges;
+    const uint8_t bandEdgeCount;
+    size_t count = 0;
+
+    void analyzeAxis(float* data, char axis, float sampleRateHz, SensorResult& result) const;
+};
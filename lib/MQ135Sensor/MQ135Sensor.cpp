@@ -2,21 +2,41 @@
 #include <ArduinoLog.h>
 
 #include "MQ135Sensor.h"
+#include "AdcScanner.h"
 #include "../../include/SensorExceptions.h"
 
+// Gas concentrations in ppm; values outside the int16 range fall back to float
+static constexpr FieldSchema FIELD_SCHEMA[] = {
+    {"CO", 0.1f, 0.0f, FieldPriority::ALARM, MQ135_CO_ALARM_PPM},
+    {"Alcohol", 0.01f, 0.0f},
+    {"CO2", 0.1f, 0.0f},
+    {"Toluen", 0.01f, 0.0f},
+    {"NH4", 0.01f, 0.0f},
+    {"Aceton", 0.01f, 0.0f},
+};
+
+// R0 is calibrated in clean air at 20 C and 33 %RH
+static constexpr float MQ135_R0 = 10.0f;
+static constexpr float REFERENCE_HUMIDITY = 33.0f;
+
 void MQ135Sensor::begin() {
 
     if (isInitialized) {
         Log.warning(F("MQ135Sensor already initialized."));
         return;
     }
+
+    // MQUnifiedsensor samples the pin with analogRead()
+    AdcScanner::claimDirectRead(analogPin);
     
     mqSensor.setRegressionMethod(1); // _PPM = a * ratio ^ b
     mqSensor.init();
-    mqSensor.serialDebug(true);
+#if MQ135_SERIAL_DEBUG
+    mqSensor.serialDebug(true); // Prints straight to Serial, blocking until the UART drains
+#endif
 
     // TODO: Add calibration logic
-    mqSensor.setR0(10.0f);
+    mqSensor.setR0(MQ135_R0);
 
     isInitialized = true;
 }
@@ -45,8 +65,9 @@ SensorResult MQ135Sensor::readValues(bool force, bool updateReadTime) {
 
     SensorResult result(getSensorName());
 
-    // Correction factor should be calculated based on temperature/humidity if available
-    float correctionFactor = 0.0f; // TODO: Implement environmental correction
+    // Rs rises in cold, dry air: dividing R0 by the same factor keeps Rs/R0 on the 20 C, 33 %RH curve.
+    // The additive correction of readSensor() is left at 0.
+    mqSensor.setR0(MQ135_R0 * correctionFactor());
 
     /*
         Exponential regression:
@@ -62,42 +83,69 @@ SensorResult MQ135Sensor::readValues(bool force, bool updateReadTime) {
     // CO
     mqSensor.setA(605.18f);
     mqSensor.setB(-3.937f);
-    float co = mqSensor.readSensor(false, correctionFactor);
+    float co = mqSensor.readSensor();
     result.set("CO", co);
 
+#if MQ135_SERIAL_DEBUG
     mqSensor.serialDebug();
+#endif
 
     // Alcohol
     mqSensor.setA(77.255f);
     mqSensor.setB(-3.18f);
-    float alcohol = mqSensor.readSensor(false, correctionFactor);
+    float alcohol = mqSensor.readSensor();
     result.set("Alcohol", alcohol);
 
     // CO2
     mqSensor.setA(110.47f);
     mqSensor.setB(-2.862f);
-    float co2 = mqSensor.readSensor(false, correctionFactor);
+    float co2 = mqSensor.readSensor();
     result.set("CO2", co2);
 
     // Toluene
     mqSensor.setA(44.947f);
     mqSensor.setB(-3.445f);
-    float toluene = mqSensor.readSensor(false, correctionFactor);
+    float toluene = mqSensor.readSensor();
     result.set("Toluen", toluene);
 
     // NH4
     mqSensor.setA(102.2f);
     mqSensor.setB(-2.473f);
-    float nh4 = mqSensor.readSensor(false, correctionFactor);
+    float nh4 = mqSensor.readSensor();
     result.set("NH4", nh4);
 
     // Acetone
     mqSensor.setA(34.668f);
     mqSensor.setB(-3.369f);
-    float acetone = mqSensor.readSensor(false, correctionFactor);
+    float acetone = mqSensor.readSensor();
     result.set("Aceton", acetone);
 
     Log.verboseln(F("MQ135Sensor::readValues() - Read values for sensor '%s': CO: %F, Alcohol: %F, CO2: %F, Toluene: %F, NH4: %F, Aceton: %F"), getSensorName(), co, alcohol, co2, toluene, nh4, acetone);
 
     return result;
-}
\ No newline at end of file
+}
+
+void MQ135Sensor::onDependencyReading(const ISensor& producer, const SensorResult& reading) {
+    float value;
+    if (reading.tryGetValue("temp", value)) temperature = value;
+    if (reading.tryGetValue("humidity", value)) humidity = value;
+}
+
+/**
+ * Temperature and humidity dependency of Rs/R0, relative to 20 C and 33 %RH,
+ * fitted on the datasheet curves. Humidity defaults to 33 % when unknown.
+ * @return 1 if no temperature is available.
+ */
+float MQ135Sensor::correctionFactor() const {
+    if (isnan(temperature)) return 1.0f;
+    float rh = isnan(humidity) ? REFERENCE_HUMIDITY : humidity;
+    if (temperature < 20.0f) {
+        return 0.00035f * temperature * temperature - 0.02718f * temperature + 1.39538f - (rh - REFERENCE_HUMIDITY) * 0.0018f;
+    }
+    return -0.003333333f * temperature - 0.001923077f * rh + 1.130128205f;
+}
+
+const FieldSchema* MQ135Sensor::getFieldSchema(uint8_t& count) const {
+    count = sizeof(FIELD_SCHEMA) / sizeof(FIELD_SCHEMA[0]);
+    return FIELD_SCHEMA;
+}
@@ -14,11 +14,26 @@ class MQ135Sensor : public ISensor {
     void begin() override;
     void update() override;
     SensorResult readValues(bool force = false, bool updateReadTime = true) override;
-    MQ135Sensor(const char* sensorName, uint8_t pin, unsigned long interval = 60000) : ISensor(sensorName, interval), mqSensor("ESP-32", 3.3, 12, pin, "MQ-135") {}
+    const FieldSchema* getFieldSchema(uint8_t& count) const override;
+
+    /**
+     * Takes the ambient temperature ("temp", in C) and relative humidity ("humidity", in %)
+     * from the sensors declared as dependencies, to compensate the readings.
+     */
+    void onDependencyReading(const ISensor& producer, const SensorResult& reading) override;
+
+    MQ135Sensor(const char* sensorName, uint8_t pin, unsigned long interval = 60000) : ISensor(sensorName, interval), analogPin(pin), mqSensor("ESP-32", 3.3, 12, pin, "MQ-135") {}
     ~MQ135Sensor() override = default;
 
     private:
+        uint8_t analogPin;
         MQUnifiedsensor mqSensor;
         bool isInitialized = false;
+
+        // Environmental compensation, NAN until a dependency provides them
+        float temperature = NAN;
+        float humidity = NAN;
+
+        float correctionFactor() const;
         
 };
\ No newline at end of file
@@ -0,0 +1,104 @@
+#include "MadgwickFilter.h"
+#include <math.h>
+#include <string.h>
+
+static constexpr float RAD_TO_DEG_F = 57.29577951f;
+
+void MadgwickFilter::reset(float ax, float ay, float az) {
+    float roll = atan2f(ay, az);
+    float pitch = atan2f(-ax, sqrtf(ay * ay + az * az));
+
+    float cr = cosf(roll * 0.5f), sr = sinf(roll * 0.5f);
+    float cp = cosf(pitch * 0.5f), sp = sinf(pitch * 0.5f);
+    q0 = cr * cp;
+    q1 = sr * cp;
+    q2 = cr * sp;
+    q3 = -sr * sp;
+    initialized = true;
+}
+
+void MadgwickFilter::update(float gx, float gy, float gz, float ax, float ay, float az, float dt) {
+    if (!initialized) {
+        reset(ax, ay, az);
+        return;
+    }
+
+    // Rate of change of the quaternion from the gyroscope
+    float qDot1 = 0.5f * (-q1 * gx - q2 * gy - q3 * gz);
+    float qDot2 = 0.5f * (q0 * gx + q2 * gz - q3 * gy);
+    float qDot3 = 0.5f * (q0 * gy - q1 * gz + q3 * gx);
+    float qDot4 = 0.5f * (q0 * gz + q1 * gy - q2 * gx);
+
+    // Gradient descent step towards the measured gravity, skipped in free fall
+    if (!(ax == 0.0f && ay == 0.0f && az == 0.0f)) {
+        float recipNorm = invSqrt(ax * ax + ay * ay + az * az);
+        ax *= recipNorm;
+        ay *= recipNorm;
+        az *= recipNorm;
+
+        float _2q0 = 2.0f * q0, _2q1 = 2.0f * q1, _2q2 = 2.0f * q2, _2q3 = 2.0f * q3;
+        float _4q0 = 4.0f * q0, _4q1 = 4.0f * q1, _4q2 = 4.0f * q2;
+        float _8q1 = 8.0f * q1, _8q2 = 8.0f * q2;
+        float q0q0 = q0 * q0, q1q1 = q1 * q1, q2q2 = q2 * q2, q3q3 = q3 * q3;
+
+        float s0 = _4q0 * q2q2 + _2q2 * ax + _4q0 * q1q1 - _2q1 * ay;
+        float s1 = _4q1 * q3q3 - _2q3 * ax + 4.0f * q0q0 * q1 - _2q0 * ay - _4q1 + _8q1 * q1q1 + _8q1 * q2q2 + _4q1 * az;
+        float s2 = 4.0f * q0q0 * q2 + _2q0 * ax + _4q2 * q3q3 - _2q3 * ay - _4q2 + _8q2 * q1q1 + _8q2 * q2q2 + _4q2 * az;
+        float s3 = 4.0f * q1q1 * q3 - _2q1 * ax + 4.0f * q2q2 * q3 - _2q2 * ay;
+        float sNorm = s0 * s0 + s1 * s1 + s2 * s2 + s3 * s3;
+        if (sNorm > 0.0f) {
+            recipNorm = invSqrt(sNorm);
+            qDot1 -= beta * s0 * recipNorm;
+            qDot2 -= beta * s1 * recipNorm;
+            qDot3 -= beta * s2 * recipNorm;
+            qDot4 -= beta * s3 * recipNorm;
+        }
+    }
+
+    q0 += qDot1 * dt;
+    q1 += qDot2 * dt;
+    q2 += qDot3 * dt;
+    q3 += qDot4 * dt;
+
+    float recipNorm = invSqrt(q0 * q0 + q1 * q1 + q2 * q2 + q3 * q3);
+    q0 *= recipNorm;
+    q1 *= recipNorm;
+    q2 *= recipNorm;
+    q3 *= recipNorm;
+}
+
+MadgwickFilter::Euler MadgwickFilter::getEuler() const {
+    Euler e;
+    e.roll = atan2f(q0 * q1 + q2 * q3, 0.5f - q1 * q1 - q2 * q2) * RAD_TO_DEG_F;
+    float sinPitch = 2.0f * (q0 * q2 - q1 * q3);
+    if (sinPitch > 1.0f) sinPitch = 1.0f;
+    if (sinPitch < -1.0f) sinPitch = -1.0f;
+    e.pitch = asinf(sinPitch) * RAD_TO_DEG_F;
+    e.yaw = atan2f(q1 * q2 + q0 * q3, 0.5f - q2 * q2 - q3 * q3) * RAD_TO_DEG_F;
+    return e;
+}
+
+float MadgwickFilter::getTilt() const {
+    // z component of the sensor z axis expressed in the world frame
+    float cosTilt = 1.0f - 2.0f * (q1 * q1 + q2 * q2);
+    if (cosTilt > 1.0f) cosTilt = 1.0f;
+    if (cosTilt < -1.0f) cosTilt = -1.0f;
+    return acosf(cosTilt) * RAD_TO_DEG_F;
+}
+
+/**
+ * Fast inverse square root with two Newton iterations (relative error below 5e-6).
+ * The ESP32 FPU has no divide or square root instruction, so this is much cheaper
+ * than 1.0f / sqrtf(x).
+ */
+float MadgwickFilter::invSqrt(float x) {
+    float halfx = 0.5f * x;
+    uint32_t i;
+    memcpy(&i, &x, sizeof(i));
+    i = 0x5f375a86 - (i >> 1);
+    float y;
+    memcpy(&y, &i, sizeof(y));
+    y = y * (1.5f - halfx * y * y);
+    y = y * (1.5f - halfx * y * y);
+    return y;
+}
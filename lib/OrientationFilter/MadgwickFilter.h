@@ -0,0 +1,60 @@
+#pragma once
+
+#include <Arduino.h>
+
+/**
+ * @brief Madgwick gradient descent orientation filter for a 6 axis IMU.
+ * Integrates the gyroscope and corrects its drift towards the gravity direction measured
+ * by the accelerometer. Without a magnetometer the yaw is relative to the start-up
+ * heading and slowly drifts; roll, pitch and tilt are absolute.
+ * Everything is single precision, so it runs on the ESP32 FPU without double emulation.
+ */
+class MadgwickFilter {
+public:
+    struct Euler {
+        float roll;  // degrees, rotation about x
+        float pitch; // degrees, rotation about y
+        float yaw;   // degrees, rotation about z, relative to the initial heading
+    };
+
+    /**
+     * @param beta Gain of the accelerometer correction: higher converges faster but lets
+     *             more linear acceleration leak into the orientation.
+     */
+    explicit MadgwickFilter(float beta) : beta(beta) {}
+
+    /**
+     * Aligns the orientation with gravity from a single accelerometer sample, so the
+     * filter does not have to converge from the identity at start-up.
+     */
+    void reset(float ax, float ay, float az);
+
+    /**
+     * Advances the filter by one sample.
+     * @param gx,gy,gz Angular rate in rad/s.
+     * @param ax,ay,az Acceleration in any unit, only its direction is used.
+     * @param dt Time since the previous sample in seconds.
+     */
+    void update(float gx, float gy, float gz, float ax, float ay, float az, float dt);
+
+    float qw() const { return q0; }
+    float qx() const { return q1; }
+    float qy() const { return q2; }
+    float qz() const { return q3; }
+
+    Euler getEuler() const;
+
+    /**
+     * Angle between the sensor z axis and the vertical, in degrees.
+     */
+    float getTilt() const;
+
+    bool isInitialized() const { return initialized; }
+
+private:
+    const float beta;
+    float q0 = 1.0f, q1 = 0.0f, q2 = 0.0f, q3 = 0.0f;
+    bool initialized = false;
+
+    static float invSqrt(float x);
+};
@@ -0,0 +1,135 @@
+#include "ReadingBuffer.h"
+#include <ArduinoLog.h>
+
+ReadingBuffer::ReadingBuffer(size_t capacityBytes) : storage(new uint8_t[capacityBytes]), capacity(capacityBytes) {}
+
+ReadingBuffer::~ReadingBuffer() {
+    delete[] storage;
+}
+
+bool ReadingBuffer::push(const SensorResult& result, int64_t timestampMs) {
+    uint8_t count = result.countEntries();
+    if (count == 0) {
+        return false;
+    }
+
+    uint8_t schemaCount;
+    const FieldSchema* schema = result.getSchema(schemaCount);
+
+    // First pass: size of the record once quantized
+    size_t size = HEADER_SIZE;
+    for (uint8_t i = 0; i < count; i++) {
+        int idx = findSchemaIndex(schema, schemaCount, result.getKey(i));
+        int16_t q;
+        size += (idx >= 0 && schema[idx].quantize(result.getValue(i), q)) ? QUANTIZED_ENTRY_SIZE : FLOAT_ENTRY_SIZE;
+    }
+    if (size > capacity || size > UINT16_MAX) {
+        return false;
+    }
+
+    while (capacity - used < size) {
+        pop();
+        dropped++;
+    }
+
+    size_t offset = (head + used) % capacity;
+    const char* sensorName = result.getSensorName();
+    uint16_t recordSize = static_cast<uint16_t>(size);
+    writeAt(offset, &timestampMs, sizeof(timestampMs));
+    writeAt(offset + sizeof(int64_t), &sensorName, sizeof(sensorName));
+    writeAt(offset + SCHEMA_OFFSET, &schema, sizeof(schema));
+    writeAt(offset + COUNT_OFFSET, &count, sizeof(count));
+    writeAt(offset + SIZE_OFFSET, &recordSize, sizeof(recordSize));
+
+    // Second pass: entries
+    size_t entryOffset = offset + HEADER_SIZE;
+    for (uint8_t i = 0; i < count; i++) {
+        const char* key = result.getKey(i);
+        float value = result.getValue(i);
+        int idx = findSchemaIndex(schema, schemaCount, key);
+        int16_t q;
+        if (idx >= 0 && schema[idx].quantize(value, q)) {
+            uint8_t tag = static_cast<uint8_t>(idx);
+            writeAt(entryOffset, &tag, sizeof(tag));
+            writeAt(entryOffset + 1, &q, sizeof(q));
+            entryOffset += QUANTIZED_ENTRY_SIZE;
+        } else {
+            char paddedKey[SENSORENTRY_MAX_KEY_LEN] = {0};
+            strncpy(paddedKey, key, SENSORENTRY_MAX_KEY_LEN - 1);
+            writeAt(entryOffset, &FLOAT_TAG, sizeof(FLOAT_TAG));
+            writeAt(entryOffset + 1, paddedKey, SENSORENTRY_MAX_KEY_LEN);
+            writeAt(entryOffset + 1 + SENSORENTRY_MAX_KEY_LEN, &value, sizeof(value));
+            entryOffset += FLOAT_ENTRY_SIZE;
+        }
+    }
+
+    used += size;
+    readings++;
+    return true;
+}
+
+bool ReadingBuffer::peek(const Cursor& cursor, RecordHeader& header) const {
+    if (cursor.remaining == 0) {
+        return false;
+    }
+    readAt(cursor.offset, &header.timestampMs, sizeof(int64_t));
+    readAt(cursor.offset + sizeof(int64_t), &header.sensorName, sizeof(const char*));
+    readAt(cursor.offset + COUNT_OFFSET, &header.count, sizeof(uint8_t));
+    return true;
+}
+
+void ReadingBuffer::advance(Cursor& cursor) const {
+    if (cursor.remaining == 0) {
+        return;
+    }
+    uint16_t size;
+    readAt(cursor.offset + SIZE_OFFSET, &size, sizeof(size));
+    cursor.offset = (cursor.offset + size) % capacity;
+    cursor.remaining--;
+}
+
+void ReadingBuffer::pop() {
+    if (readings == 0) {
+        return;
+    }
+    uint16_t size;
+    readAt(head + SIZE_OFFSET, &size, sizeof(size));
+    head = (head + size) % capacity;
+    used -= size;
+    readings--;
+}
+
+void ReadingBuffer::pop(size_t count) {
+    while (count-- > 0 && readings > 0) {
+        pop();
+    }
+}
+
+void ReadingBuffer::clear() {
+    head = 0;
+    used = 0;
+    readings = 0;
+}
+
+void ReadingBuffer::writeAt(size_t offset, const void* src, size_t len) {
+    offset %= capacity;
+    size_t first = (len < capacity - offset) ? len : capacity - offset;
+    memcpy(storage + offset, src, first);
+    memcpy(storage, static_cast<const uint8_t*>(src) + first, len - first);
+}
+
+void ReadingBuffer::readAt(size_t offset, void* dst, size_t len) const {
+    offset %= capacity;
+    size_t first = (len < capacity - offset) ? len : capacity - offset;
+    memcpy(dst, storage + offset, first);
+    memcpy(static_cast<uint8_t*>(dst) + first, storage, len - first);
+}
+
+int ReadingBuffer::findSchemaIndex(const FieldSchema* schema, uint8_t schemaCount, const char* key) {
+    if (schema == nullptr) return -1;
+    uint8_t limit = schemaCount < FLOAT_TAG ? schemaCount : FLOAT_TAG;
+    for (uint8_t i = 0; i < limit; i++) {
+        if (strcmp(schema[i].key, key) == 0) return i;
+    }
+    return -1;
+}
@@ -0,0 +1,163 @@
+#pragma once
+
+#include <Arduino.h>
+#include "../../include/ResultCode.h"
+#include "SensorEntry.h"
+#include "SensorResult.h"
+#include "FieldSchema.h"
+
+/**
+ * @brief Fixed-size ring buffer of timestamped sensor readings.
+ * Readings are serialized back to back into a single byte array, so the memory used is
+ * bounded by the capacity given at construction and no allocation happens per reading.
+ * When the buffer is full the oldest readings are dropped to make room for new ones.
+ *
+ * Fields declared in the sensor's FieldSchema are stored as a one byte schema index and
+ * an int16 quantized value (3 bytes); other fields keep their key and float value.
+ */
+class ReadingBuffer {
+public:
+    /**
+     * Header of a buffered reading.
+     */
+    struct RecordHeader {
+        int64_t timestampMs;    // Unix time in ms
+        const char* sensorName; // Sensor names are static strings owned by the sensors
+        uint8_t count;
+    };
+
+    /**
+     * A field restored from the buffer.
+     */
+    struct Field {
+        char key[SENSORENTRY_MAX_KEY_LEN];
+        float value;
+        int8_t decimals; // Decimals needed to print the value exactly, -1 if not quantized
+    };
+
+    /**
+     * Position of a reading, for reading ahead of the oldest one without removing anything.
+     * Invalidated by push() and pop().
+     */
+    struct Cursor {
+        size_t offset;
+        size_t remaining; // Readings from this one to the newest, 0 past the end
+    };
+
+    /**
+     * @param capacityBytes Size of the underlying storage in bytes.
+     */
+    explicit ReadingBuffer(size_t capacityBytes);
+    ~ReadingBuffer();
+
+    ReadingBuffer(const ReadingBuffer&) = delete;
+    ReadingBuffer& operator=(const ReadingBuffer&) = delete;
+
+    /**
+     * Appends a reading, dropping the oldest ones if there is not enough space.
+     * Uses the schema attached to the result, if any, to quantize its fields.
+     * @return false if the reading is empty or larger than the whole buffer.
+     */
+    bool push(const SensorResult& result, int64_t timestampMs);
+
+    /**
+     * Reads the header of the oldest reading.
+     * @return false if the buffer is empty.
+     */
+    bool peek(RecordHeader& header) const { return peek(front(), header); }
+
+    /**
+     * Calls visit(const Field&) for every field of the oldest reading, in order.
+     */
+    template<typename Visitor>
+    void forEachField(Visitor&& visit) const { forEachField(front(), visit); }
+
+    /**
+     * @return Cursor on the oldest reading.
+     */
+    Cursor front() const { return {head, readings}; }
+
+    /**
+     * Moves the cursor to the next newer reading.
+     */
+    void advance(Cursor& cursor) const;
+
+    /**
+     * Reads the header of the reading at the cursor.
+     * @return false if the cursor is past the newest reading.
+     */
+    bool peek(const Cursor& cursor, RecordHeader& header) const;
+
+    /**
+     * Calls visit(const Field&) for every field of the reading at the cursor, in order.
+     */
+    template<typename Visitor>
+    void forEachField(const Cursor& cursor, Visitor&& visit) const {
+        if (cursor.remaining == 0) return;
+        const FieldSchema* schema;
+        uint8_t count;
+        readAt(cursor.offset + SCHEMA_OFFSET, &schema, sizeof(schema));
+        readAt(cursor.offset + COUNT_OFFSET, &count, sizeof(count));
+
+        size_t offset = cursor.offset + HEADER_SIZE;
+        for (uint8_t i = 0; i < count; i++) {
+            Field field;
+            uint8_t tag;
+            readAt(offset, &tag, sizeof(tag));
+            if (tag == FLOAT_TAG) {
+                readAt(offset + 1, field.key, SENSORENTRY_MAX_KEY_LEN);
+                readAt(offset + 1 + SENSORENTRY_MAX_KEY_LEN, &field.value, sizeof(float));
+                field.decimals = -1;
+                offset += FLOAT_ENTRY_SIZE;
+            } else {
+                int16_t q;
+                readAt(offset + 1, &q, sizeof(q));
+                const FieldSchema& fieldSchema = schema[tag];
+                strncpy(field.key, fieldSchema.key, SENSORENTRY_MAX_KEY_LEN - 1);
+                field.key[SENSORENTRY_MAX_KEY_LEN - 1] = '\0';
+                field.value = fieldSchema.dequantize(q);
+                field.decimals = fieldSchema.decimals();
+                offset += QUANTIZED_ENTRY_SIZE;
+            }
+            visit(static_cast<const Field&>(field));
+        }
+    }
+
+    /**
+     * Removes the oldest reading.
+     */
+    void pop();
+
+    /**
+     * Removes the count oldest readings, e.g. once they were read through a cursor and sent.
+     */
+    void pop(size_t count);
+
+    void clear();
+
+    size_t countReadings() const { return readings; }
+    size_t usedBytes() const { return used; }
+    size_t capacityBytes() const { return capacity; }
+    uint32_t droppedReadings() const { return dropped; }
+    bool isEmpty() const { return readings == 0; }
+
+private:
+    static constexpr size_t SCHEMA_OFFSET = sizeof(int64_t) + sizeof(const char*);
+    static constexpr size_t COUNT_OFFSET = SCHEMA_OFFSET + sizeof(const FieldSchema*);
+    static constexpr size_t SIZE_OFFSET = COUNT_OFFSET + sizeof(uint8_t);
+    static constexpr size_t HEADER_SIZE = SIZE_OFFSET + sizeof(uint16_t);
+    static constexpr uint8_t FLOAT_TAG = 0xFF;
+    static constexpr size_t FLOAT_ENTRY_SIZE = 1 + SENSORENTRY_MAX_KEY_LEN + sizeof(float);
+    static constexpr size_t QUANTIZED_ENTRY_SIZE = 1 + sizeof(int16_t);
+
+    uint8_t* storage;
+    const size_t capacity;
+    size_t head = 0; // Offset of the oldest reading
+    size_t used = 0;
+    size_t readings = 0;
+    uint32_t dropped = 0;
+
+    void writeAt(size_t offset, const void* src, size_t len);
+    void readAt(size_t offset, void* dst, size_t len) const;
+    static int findSchemaIndex(const FieldSchema* schema, uint8_t schemaCount, const char* key);
+};
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <Arduino.h>
+
+/**
+ * @brief A predicate on one field of one sensor.
+ * The rule fires when the watched quantity crosses the threshold and clears only once it
+ * has moved back past the threshold by the hysteresis, so noisy readings do not flap.
+ * Rules are plain constants; build them with the factory functions below.
+ */
+struct Rule {
+    enum class Type : uint8_t {
+        ABOVE,      // Fires when value >= threshold
+        BELOW,      // Fires when value <= threshold
+        RATE_ABOVE, // Fires when the change per second >= threshold
+        RATE_BELOW  // Fires when the change per second <= threshold (use a negative threshold for drops)
+    };
+
+    const char* name;       // Measurement name of the emitted events
+    const char* sensorName; // Sensor producing the field
+    const char* key;        // Field of the sensor result
+    Type type;
+    float threshold;
+    float hysteresis;
+
+    static constexpr Rule above(const char* name, const char* sensorName, const char* key, float threshold, float hysteresis = 0.0f) {
+        return {name, sensorName, key, Type::ABOVE, threshold, hysteresis};
+    }
+
+    static constexpr Rule below(const char* name, const char* sensorName, const char* key, float threshold, float hysteresis = 0.0f) {
+        return {name, sensorName, key, Type::BELOW, threshold, hysteresis};
+    }
+
+    static constexpr Rule rateAbove(const char* name, const char* sensorName, const char* key, float perSecond, float hysteresis = 0.0f) {
+        return {name, sensorName, key, Type::RATE_ABOVE, perSecond, hysteresis};
+    }
+
+    static constexpr Rule rateBelow(const char* name, const char* sensorName, const char* key, float perSecond, float hysteresis = 0.0f) {
+        return {name, sensorName, key, Type::RATE_BELOW, perSecond, hysteresis};
+    }
+
+    bool isRate() const {
+        return type == Type::RATE_ABOVE || type == Type::RATE_BELOW;
+    }
+
+    bool firesAbove() const {
+        return type == Type::ABOVE || type == Type::RATE_ABOVE;
+    }
+};
@@ -0,0 +1,89 @@
+#include "RulesEngine.h"
+#include <ArduinoLog.h>
+
+// Events are urgent whatever their value, so a clear is delivered as fast as the alarm
+static constexpr FieldSchema EVENT_SCHEMA[] = {
+    {"active", 1.0f, 0.0f, FieldPriority::ALARM},
+    {"value", 0.0f, 0.0f},
+};
+
+bool RulesEngine::addRule(const Rule& rule) {
+    if (ruleCount >= RULES_ENGINE_MAX_RULES) {
+        Log.errorln(F("[RulesEngine] Too many rules, '%s' ignored."), rule.name);
+        return false;
+    }
+    rules[ruleCount] = rule;
+    states[ruleCount] = RuleState();
+    ruleCount++;
+    return true;
+}
+
+bool RulesEngine::step(uint8_t index, const SensorResult& result, unsigned long now) {
+    const Rule& rule = rules[index];
+    RuleState& state = states[index];
+
+    // Sensor names are static strings, so the pointer compare almost always decides
+    const char* sensorName = result.getSensorName();
+    if (sensorName != rule.sensorName && strcmp(sensorName, rule.sensorName) != 0) return false;
+
+    float value;
+    if (!result.tryGetValue(rule.key, value)) return false;
+
+    float metric = value;
+    if (rule.isRate()) {
+        bool hadLast = state.hasLast;
+        unsigned long elapsedMs = now - state.lastMs;
+        float lastValue = state.lastValue;
+        state.hasLast = true;
+        state.lastValue = value;
+        state.lastMs = now;
+        if (!hadLast || elapsedMs == 0) return false;
+        metric = (value - lastValue) * 1000.0f / elapsedMs;
+    }
+
+    bool active;
+    if (rule.firesAbove()) {
+        active = state.active ? metric > rule.threshold - rule.hysteresis : metric >= rule.threshold;
+    } else {
+        active = state.active ? metric < rule.threshold + rule.hysteresis : metric <= rule.threshold;
+    }
+    if (active == state.active) return false;
+
+    state.active = active;
+    state.lastMetric = metric;
+    return true;
+}
+
+SensorResult RulesEngine::makeEvent(uint8_t index) const {
+    const Rule& rule = rules[index];
+    const RuleState& state = states[index];
+
+    Log.noticeln(F("[RulesEngine] Rule '%s' %s (%s.%s = %F)"), rule.name, state.active ? "fired" : "cleared",
+                 rule.sensorName, rule.key, state.lastMetric);
+
+    SensorResult event(rule.name);
+    event.set("active", state.active ? 1.0f : 0.0f);
+    event.set("value", state.lastMetric);
+    event.setSchema(EVENT_SCHEMA, sizeof(EVENT_SCHEMA) / sizeof(EVENT_SCHEMA[0]));
+    return event;
+}
+
+bool RulesEngine::isActive(const char* name) const {
+    for (uint8_t i = 0; i < ruleCount; i++) {
+        if (strcmp(rules[i].name, name) == 0) return states[i].active;
+    }
+    return false;
+}
+
+void RulesEngine::recordEvaluation(uint32_t elapsedUs) {
+    stats.evaluations++;
+    stats.totalEvalUs += elapsedUs;
+    if (elapsedUs > stats.maxEvalUs) stats.maxEvalUs = elapsedUs;
+}
+
+void RulesEngine::logStats() const {
+    if (stats.evaluations == 0) return;
+    Log.notice(F("[RulesEngine] %u rules, %u results evaluated (avg %u us, max %u us), %u events\n"),
+               ruleCount, stats.evaluations, static_cast<uint32_t>(stats.totalEvalUs / stats.evaluations),
+               stats.maxEvalUs, stats.events);
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <Arduino.h>
+#include <esp_timer.h>
+#include "settings.h"
+#include "SensorResult.h"
+#include "FieldSchema.h"
+#include "Rule.h"
+
+/**
+ * @brief Evaluates threshold, rate of change and hysteresis rules on every sensor result.
+ * Rules live in a fixed array with their runtime state next to them, and evaluation is a
+ * pointer compare on the sensor name plus one field lookup per matching rule, so it does
+ * not allocate. When a rule fires or clears an event result is emitted, named after the
+ * rule, with the fields "active" (1 or 0) and "value" (the value that crossed the threshold,
+ * or the rate for rate rules). Events carry an alarm schema, so the logger sends them on
+ * the priority lane.
+ */
+class RulesEngine {
+public:
+    struct Stats {
+        uint32_t evaluations = 0; // Results evaluated
+        uint32_t events = 0;      // Events emitted
+        uint64_t totalEvalUs = 0; // Time spent evaluating, excluding event delivery
+        uint32_t maxEvalUs = 0;
+    };
+
+    /**
+     * Adds a rule. Must be called before the first evaluation.
+     * @return false if RULES_ENGINE_MAX_RULES rules are already registered.
+     */
+    bool addRule(const Rule& rule);
+
+    /**
+     * Evaluates every rule watching the sensor that produced the result.
+     * Calls onEvent(const SensorResult&) for each rule that fired or cleared.
+     * @return Number of events emitted.
+     */
+    template<typename Callback>
+    uint8_t evaluate(const SensorResult& result, Callback&& onEvent) {
+        int64_t start = esp_timer_get_time();
+        uint32_t changed = 0;
+        unsigned long now = millis();
+        for (uint8_t i = 0; i < ruleCount; i++) {
+            if (step(i, result, now)) changed |= 1UL << i;
+        }
+        recordEvaluation(static_cast<uint32_t>(esp_timer_get_time() - start));
+        if (changed == 0) return 0;
+
+        // Events are rare, building them is kept out of the timed path
+        uint8_t emitted = 0;
+        for (uint8_t i = 0; i < ruleCount; i++) {
+            if (!(changed & (1UL << i))) continue;
+            SensorResult event = makeEvent(i);
+            onEvent(event);
+            emitted++;
+        }
+        stats.events += emitted;
+        return emitted;
+    }
+
+    /**
+     * @return true if the rule with the given name is currently firing.
+     */
+    bool isActive(const char* name) const;
+
+    uint8_t countRules() const { return ruleCount; }
+
+    Stats getStats() const { return stats; }
+
+    void logStats() const;
+
+private:
+    static_assert(RULES_ENGINE_MAX_RULES <= 32, "Changed rules are tracked in a 32 bit mask");
+
+    struct RuleState {
+        bool active = false;
+        bool hasLast = false;    // Rate rules need a previous sample
+        float lastValue = 0.0f;
+        unsigned long lastMs = 0;
+        float lastMetric = 0.0f; // Value or rate at the last transition
+    };
+
+    Rule rules[RULES_ENGINE_MAX_RULES];
+    RuleState states[RULES_ENGINE_MAX_RULES];
+    uint8_t ruleCount = 0;
+    Stats stats;
+
+    /**
+     * Updates the state of a rule with the result.
+     * @return true if the rule fired or cleared.
+     */
+    bool step(uint8_t index, const SensorResult& result, unsigned long now);
+    SensorResult makeEvent(uint8_t index) const;
+    void recordEvaluation(uint32_t elapsedUs);
+};
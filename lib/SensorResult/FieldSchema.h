@@ -0,0 +1,59 @@
+#pragma once
+
+#include <Arduino.h>
+#include <math.h>
+
+/**
+ * Delivery class of a field.
+ */
+enum class FieldPriority : uint8_t {
+    BULK,  // Batched with the regular telemetry
+    ALARM  // Sent immediately on the priority lane when above its alarm threshold
+};
+
+/**
+ * Describes how a sensor field is stored while buffered and how urgently it is delivered.
+ * Fields with a scale are quantized to int16 as (value - offset) / scale and
+ * restored exactly at encode time with as many decimals as the scale needs.
+ */
+struct FieldSchema {
+    const char* key;
+    float scale;  // Resolution of the stored value, 0 to keep the field as float
+    float offset; // Value stored as 0, shifts the int16 range
+    FieldPriority priority = FieldPriority::BULK;
+    float alarmThreshold = NAN; // ALARM fields are urgent at or above this value (always if NAN)
+
+    /**
+     * @return true if this value must bypass batching.
+     */
+    bool isUrgent(float value) const {
+        return priority == FieldPriority::ALARM && (isnan(alarmThreshold) || value >= alarmThreshold);
+    }
+
+    bool isQuantized() const {
+        return scale > 0.0f;
+    }
+
+    /**
+     * @return false if the value cannot be represented (NaN or out of the int16 range).
+     */
+    bool quantize(float value, int16_t& out) const {
+        if (!isQuantized() || isnan(value)) return false;
+        float q = roundf((value - offset) / scale);
+        if (q < -32768.0f || q > 32767.0f) return false;
+        out = static_cast<int16_t>(q);
+        return true;
+    }
+
+    float dequantize(int16_t q) const {
+        return q * scale + offset;
+    }
+
+    /**
+     * Decimals needed to print a dequantized value exactly.
+     */
+    uint8_t decimals() const {
+        float d = ceilf(-log10f(scale) - 1e-4f);
+        return d > 0.0f ? static_cast<uint8_t>(d) : 0;
+    }
+};
@@ -84,6 +84,16 @@ float SensorResult::getValue(uint8_t idx) const {
     throw std::out_of_range("Index out of range");
 }
 
+bool SensorResult::tryGetValue(const char* key, float& value) const {
+    for (SensorResultNode* node = head; node; node = node->next) {
+        if (strcmp(node->entry.key, key) == 0) {
+            value = node->entry.value;
+            return true;
+        }
+    }
+    return false;
+}
+
 uint8_t SensorResult::countEntries() const {
     return count;
 }
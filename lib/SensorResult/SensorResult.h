@@ -6,6 +6,7 @@
 #include "../../include/SensorExceptions.h"
 #include "SensorEntry.h"
 #include "SensorResultNode.h"
+#include "FieldSchema.h"
 
 class SensorResult {
 
@@ -15,18 +16,22 @@ private:
 
     uint8_t count;
     const char* sensorName;
+    const FieldSchema* schema = nullptr;
+    uint8_t schemaCount = 0;
 
 public:
 
     SensorResult(const char* sensorName = "Unknown") : head(nullptr), tail(nullptr), count(0), sensorName(sensorName) {}
 
     // Copy constructor
-    SensorResult(const SensorResult& other) : head(nullptr), tail(nullptr), count(0), sensorName(other.sensorName) {
+    SensorResult(const SensorResult& other) : head(nullptr), tail(nullptr), count(0), sensorName(other.sensorName),
+                                              schema(other.schema), schemaCount(other.schemaCount) {
         copyFrom(other);
     }
 
     // Move constructor
-    SensorResult(SensorResult&& other) noexcept : head(other.head), tail(other.tail), count(other.count), sensorName(other.sensorName) {
+    SensorResult(SensorResult&& other) noexcept : head(other.head), tail(other.tail), count(other.count), sensorName(other.sensorName),
+                                                  schema(other.schema), schemaCount(other.schemaCount) {
         other.head = nullptr;
         other.tail = nullptr;
         other.count = 0;
@@ -38,6 +43,8 @@ public:
         if (this != &other) {
             clear();
             sensorName = other.sensorName;
+            schema = other.schema;
+            schemaCount = other.schemaCount;
             copyFrom(other);
         }
         return *this;
@@ -51,6 +58,8 @@ public:
             tail = other.tail;
             count = other.count;
             sensorName = other.sensorName;
+            schema = other.schema;
+            schemaCount = other.schemaCount;
             
             other.head = nullptr;
             other.tail = nullptr;
@@ -70,6 +79,12 @@ public:
 
     float getValue(uint8_t idx) const;
 
+    /**
+     * Looks up a value without logging or throwing, for per-sample hot paths.
+     * @return false if the key is not present.
+     */
+    bool tryGetValue(const char* key, float& value) const;
+
     const char* getKey(uint8_t idx) const;
 
     uint8_t countEntries() const;
@@ -84,6 +99,19 @@ public:
         return sensorName;
     }
 
+    /**
+     * Attaches the field schema of the sensor that produced this result.
+     */
+    void setSchema(const FieldSchema* fieldSchema, uint8_t fieldCount) {
+        schema = fieldSchema;
+        schemaCount = fieldCount;
+    }
+
+    const FieldSchema* getSchema(uint8_t& fieldCount) const {
+        fieldCount = schemaCount;
+        return schema;
+    }
+
     bool isEmpty() const { 
         return count == 0; 
     }
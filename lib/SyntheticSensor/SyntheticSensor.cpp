@@ -0,0 +1,90 @@
+#include "SyntheticSensor.h"
+#include <ArduinoLog.h>
+#include <math.h>
+#include "../../include/SensorExceptions.h"
+
+SyntheticSensor::SyntheticSensor(const char* sensorName, uint8_t fieldCount, float rateHz, uint32_t seed)
+    : ISensor(sensorName, rateHz >= 1000.0f ? 1 : static_cast<unsigned long>(1000.0f / rateHz)),
+      fieldCount(fieldCount > MAX_FIELDS ? MAX_FIELDS : fieldCount),
+      fields(new FieldState[this->fieldCount]),
+      schema(new FieldSchema[this->fieldCount + 1]),
+      rngState(seed != 0 ? seed : 1) {}
+
+SyntheticSensor::~SyntheticSensor() {
+    delete[] fields;
+    delete[] schema;
+}
+
+void SyntheticSensor::begin() {
+    for (uint8_t i = 0; i < fieldCount; i++) {
+        FieldState& field = fields[i];
+        snprintf(field.key, sizeof(field.key), "f%u", static_cast<unsigned>(i));
+        // Spread the fields over the ranges of real sensors: temperatures, ppm, dB, volts
+        field.base = 1.0f + 100.0f * uniform();
+        field.amplitude = field.base * (0.05f + 0.2f * uniform());
+        field.periodMs = 60000.0f + 540000.0f * uniform();
+        field.walk = 0.0f;
+        field.noise = field.base * 0.01f;
+        // Quantize every other field, as real sensors mix both kinds
+        schema[i] = {field.key, (i % 2 == 0) ? 0.01f : 0.0f, 0.0f};
+    }
+    schema[fieldCount] = {"seq", 0.0f, 0.0f}; // Exact as float up to 2^24 readings
+    isInitialized = true;
+    Log.notice(F("[SyntheticSensor] %s emits %d fields every %u ms" CR), getSensorName(), fieldCount, updateInterval);
+}
+
+void SyntheticSensor::update() {
+    if (!isInitialized) {
+        throw SensorNotInitializedException();
+    }
+}
+
+SensorResult SyntheticSensor::readValues(bool force, bool updateReadTime) {
+    if (!isInitialized) {
+        throw SensorNotInitializedException();
+    }
+
+    unsigned long now = millis();
+    if (!force && now - lastReadTime < updateInterval) {
+        return SensorResult(getSensorName());
+    }
+    if (updateReadTime)
+        lastReadTime = now;
+
+    SensorResult result(getSensorName());
+    for (uint8_t i = 0; i < fieldCount; i++) {
+        result.set(fields[i].key, nextValue(fields[i], now));
+    }
+    result.set("seq", static_cast<float>(readings));
+    readings++;
+    return result;
+}
+
+float SyntheticSensor::nextValue(FieldState& field, unsigned long now) {
+    const float twoPi = 6.28318531f;
+
+    // Random walk pulled back towards 0, so it wanders without drifting away
+    field.walk = 0.99f * field.walk + (uniform() - 0.5f) * field.noise;
+    // Sum of three uniforms: close enough to gaussian noise
+    float noise = (uniform() + uniform() + uniform() - 1.5f) * field.noise;
+    float value = field.base + field.amplitude * sinf(twoPi * fmodf(now, field.periodMs) / field.periodMs) + field.walk + noise;
+    if (uniform() < 0.001f) {
+        value += field.amplitude * 5.0f; // Rare spike
+    }
+    return value;
+}
+
+/**
+ * xorshift32, mapped to [0, 1).
+ */
+float SyntheticSensor::uniform() {
+    rngState ^= rngState << 13;
+    rngState ^= rngState >> 17;
+    rngState ^= rngState << 5;
+    return (rngState >> 8) * (1.0f / 16777216.0f);
+}
+
+const FieldSchema* SyntheticSensor::getFieldSchema(uint8_t& count) const {
+    count = isInitialized ? fieldCount + 1 : 0;
+    return schema;
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <Arduino.h>
+#include "../../include/ISensor.h"
+#include "../../include/ResultCode.h"
+#include "SensorResult.h"
+
+/**
+ * @brief Sensor generating realistic looking data, for stress testing the pipeline.
+ * Emits fieldCount fields named f0, f1, ... at the given rate. Each field is a slow
+ * sine (a daily-like cycle, compressed to minutes), plus a mean-reverting random walk,
+ * noise and rare spikes, so the values exercise quantization and compression like real
+ * readings do. The generator is seeded, so runs are reproducible.
+ * Every reading also carries "seq", its sequence number from 0, so the receiving end
+ * can count the readings lost on the way (see tools/mock_influxdb.py).
+ */
+class SyntheticSensor : public ISensor {
+public:
+    static constexpr uint8_t MAX_FIELDS = 64;
+
+    /**
+     * @param sensorName Name of the sensor.
+     * @param fieldCount Fields per reading besides "seq", at most MAX_FIELDS.
+     * @param rateHz Readings per second; the loop rate is the practical upper bound.
+     * @param seed Seed of the value generator.
+     */
+    SyntheticSensor(const char* sensorName, uint8_t fieldCount, float rateHz, uint32_t seed = 1);
+    ~SyntheticSensor() override;
+
+    SyntheticSensor(const SyntheticSensor&) = delete;
+    SyntheticSensor& operator=(const SyntheticSensor&) = delete;
+
+    void begin() override;
+    void update() override;
+    SensorResult readValues(bool force = false, bool updateReadTime = true) override;
+    const FieldSchema* getFieldSchema(uint8_t& count) const override;
+
+    uint32_t getReadingsCount() const { return readings; }
+
+private:
+    struct FieldState {
+        char key[SENSORENTRY_MAX_KEY_LEN];
+        float base;
+        float amplitude;
+        float periodMs;
+        float walk;
+        float noise;
+    };
+
+    const uint8_t fieldCount;
+    FieldState* fields;
+    FieldSchema* schema;
+    uint32_t rngState;
+    uint32_t readings = 0;
+    bool isInitialized = false;
+
+    float nextValue(FieldState& field, unsigned long now);
+    float uniform();
+};
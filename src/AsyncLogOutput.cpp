@@ -0,0 +1,176 @@
+#include "AsyncLogOutput.h"
+
+AsyncLogOutput::AsyncLogOutput(Print& output) : output(output) {
+    memset(ring, 0, sizeof(ring));
+}
+
+void AsyncLogOutput::begin() {
+    xTaskCreate(taskEntry, "AsyncLog", ASYNC_LOG_TASK_STACK, this, ASYNC_LOG_TASK_PRIORITY, &task);
+}
+
+size_t AsyncLogOutput::write(uint8_t c) {
+    Stage* current = stageOfCurrentTask();
+    if (current == nullptr) {
+        return append(&c, 1) ? 1 : 0;
+    }
+    stage(*current, c);
+    return 1;
+}
+
+size_t AsyncLogOutput::write(const uint8_t* buffer, size_t size) {
+    Stage* current = stageOfCurrentTask();
+    if (current == nullptr) {
+        size_t written = 0;
+        while (written < size) {
+            uint8_t length = size - written > MAX_RECORD ? MAX_RECORD : static_cast<uint8_t>(size - written);
+            if (!append(buffer + written, length)) break;
+            written += length;
+        }
+        return written;
+    }
+    for (size_t i = 0; i < size; i++) {
+        stage(*current, buffer[i]);
+    }
+    return size;
+}
+
+/**
+ * @return The stage holding the line of the calling task, claiming a free one if it has
+ *         none, or nullptr if all of them are taken.
+ */
+AsyncLogOutput::Stage* AsyncLogOutput::stageOfCurrentTask() {
+    TaskHandle_t self = xTaskGetCurrentTaskHandle();
+    for (Stage& candidate : stages) {
+        if (candidate.owner.load(std::memory_order_relaxed) == self) return &candidate;
+    }
+    for (Stage& candidate : stages) {
+        TaskHandle_t expected = nullptr;
+        if (candidate.owner.compare_exchange_strong(expected, self, std::memory_order_acquire)) return &candidate;
+    }
+    return nullptr;
+}
+
+void AsyncLogOutput::stage(Stage& stage, uint8_t c) {
+    stage.data[stage.length++] = c;
+    if (c == '\n') {
+        commit(stage, true);
+    } else if (stage.length == MAX_RECORD) {
+        commit(stage, false);
+    }
+}
+
+/**
+ * Appends the staged bytes as one record, unless an earlier piece of the line was dropped.
+ * At the end of a line the stage is released for any task.
+ */
+void AsyncLogOutput::commit(Stage& stage, bool endOfLine) {
+    if (stage.length > 0) {
+        if (stage.dropping) {
+            droppedBytes.fetch_add(stage.length, std::memory_order_relaxed);
+        } else if (!append(stage.data, stage.length)) {
+            stage.dropping = true;
+        }
+        stage.length = 0;
+    }
+    if (endOfLine) {
+        stage.dropping = false;
+        stage.owner.store(nullptr, std::memory_order_release);
+    }
+}
+
+/**
+ * Reserves header + length bytes, copies the data and publishes the header.
+ * @return false if the ring is full; the write is dropped.
+ */
+bool AsyncLogOutput::append(const uint8_t* data, uint8_t length) {
+    uint32_t need = 1 + length;
+    uint32_t start = reserved.load(std::memory_order_relaxed);
+    do {
+        if (start + need - consumed.load(std::memory_order_acquire) > CAPACITY) {
+            droppedWrites.fetch_add(1, std::memory_order_relaxed);
+            droppedBytes.fetch_add(length, std::memory_order_relaxed);
+            return false;
+        }
+    } while (!reserved.compare_exchange_weak(start, start + need, std::memory_order_acq_rel, std::memory_order_relaxed));
+
+    for (uint8_t i = 0; i < length; i++) {
+        ring[(start + 1 + i) & MASK] = data[i];
+    }
+    // The drain stops at the first header without the committed bit
+    __atomic_store_n(&ring[start & MASK], static_cast<uint8_t>(COMMITTED | length), __ATOMIC_RELEASE);
+
+    uint32_t queued = start + need - consumed.load(std::memory_order_relaxed);
+    uint32_t peak = highWatermark.load(std::memory_order_relaxed);
+    while (queued > peak && !highWatermark.compare_exchange_weak(peak, queued, std::memory_order_relaxed)) {}
+    return true;
+}
+
+/**
+ * Sends the committed records in order, up to the first one still being written.
+ * @return Number of bytes sent.
+ */
+size_t AsyncLogOutput::drain() {
+    uint8_t chunk[128];
+    size_t chunkLength = 0;
+    size_t sent = 0;
+    uint32_t position = consumed.load(std::memory_order_relaxed);
+
+    for (;;) {
+        uint8_t header = __atomic_load_n(&ring[position & MASK], __ATOMIC_ACQUIRE);
+        if (!(header & COMMITTED)) break;
+        uint8_t length = header & MAX_RECORD;
+        if (chunkLength + length > sizeof(chunk)) {
+            output.write(chunk, chunkLength);
+            chunkLength = 0;
+        }
+        // Released bytes are zeroed, so a header not yet published always reads as uncommitted
+        for (uint8_t i = 0; i < length; i++) {
+            chunk[chunkLength++] = ring[(position + 1 + i) & MASK];
+            ring[(position + 1 + i) & MASK] = 0;
+        }
+        __atomic_store_n(&ring[position & MASK], static_cast<uint8_t>(0), __ATOMIC_RELAXED);
+        position += 1 + length;
+        consumed.store(position, std::memory_order_release);
+        sent += length;
+    }
+    if (chunkLength > 0) {
+        output.write(chunk, chunkLength);
+    }
+
+    uint32_t dropped = droppedWrites.load(std::memory_order_relaxed);
+    if (dropped != reportedDrops) {
+        output.print("[AsyncLog] Buffer full, ");
+        output.print(static_cast<unsigned long>(dropped - reportedDrops));
+        output.println(" writes dropped");
+        reportedDrops = dropped;
+    }
+    return sent;
+}
+
+void AsyncLogOutput::flush() {
+    TaskHandle_t self = xTaskGetCurrentTaskHandle();
+    for (Stage& candidate : stages) {
+        if (candidate.owner.load(std::memory_order_relaxed) == self) commit(candidate, true);
+    }
+    while (consumed.load(std::memory_order_acquire) != reserved.load(std::memory_order_acquire)) {
+        if (task == nullptr) {
+            drain();
+        } else {
+            delay(1);
+        }
+    }
+    output.flush();
+}
+
+AsyncLogOutput::Stats AsyncLogOutput::getStats() const {
+    return {droppedWrites.load(), droppedBytes.load(), highWatermark.load()};
+}
+
+void AsyncLogOutput::taskEntry(void* arg) {
+    AsyncLogOutput* self = static_cast<AsyncLogOutput*>(arg);
+    for (;;) {
+        if (self->drain() == 0) {
+            vTaskDelay(pdMS_TO_TICKS(ASYNC_LOG_DRAIN_INTERVAL_MS));
+        }
+    }
+}
@@ -1,9 +1,12 @@
 
 #include "InfluxLogger.h"
+#include <ArduinoLog.h>
 #include <WiFi.h>
 #include "SensorResult.h"
 
-InfluxLogger::InfluxLogger(const char* deviceName, bool simulated) : deviceName(deviceName), simulated(simulated) {
+static constexpr int MAX_FIELD_DECIMALS = 9; // Beyond the precision of a float
+
+InfluxLogger::InfluxLogger(const char* deviceName, bool simulated) : buffer(READING_BUFFER_SIZE), deviceName(deviceName), simulated(simulated) {
     if (simulated) {
         Log.notice(F("InfluxLogger initialized in simulated mode. No data will be sent to InfluxDB."));
     } else {
@@ -11,17 +14,17 @@ InfluxLogger::InfluxLogger(const char* deviceName, bool simulated) : deviceName(
     }
 }
 
+void InfluxLogger::addSink(LogSink* sink) {
+    sinks.push_back(sink);
+}
+
 void InfluxLogger::begin() {
     if (simulated) {
         Log.noticeln(F("InfluxLogger is in simulated mode, skipping InfluxDB connection."));
         return;
     }
 
-    //client = new InfluxDBClient(SECRET_INFLUXDB_HOST, SECRET_INFLUXDB_ORG, SECRET_INFLUXDB_BUCKET, SECRET_INFLUXDB_TOKEN, InfluxDbCloud2CACert);
-    client.setConnectionParams(SECRET_INFLUXDB_HOST, SECRET_INFLUXDB_ORG, SECRET_INFLUXDB_BUCKET, SECRET_INFLUXDB_TOKEN, InfluxDbCloud2CACert);
-    client.setInsecure();
-
-    // Time sync for certificate validation
+    // Readings are timestamped on the device, so the clock must be synced first
     //timeSync(INFLUXDB_TZ_INFO, "pool.ntp.org", "time.nis.gov");
     configTime(0, 0, "pool.ntp.org", "time.nist.gov");
 
@@ -40,14 +43,12 @@ void InfluxLogger::begin() {
     Serial.print(F("Current time: "));
     Serial.print(asctime(&timeinfo));
 
-    Log.noticeln(F("Connecting to InfluxDB at %s..."), client.getServerUrl().c_str());
-    if (client.validateConnection()) {
-        Log.noticeln(F("Connected to InfluxDB: %s"), client.getServerUrl().c_str());
-    } else {
-        Log.error(F("InfluxDB connection failed: %s"), client.getLastErrorMessage().c_str());
-        while(1) {}
+    if (sinks.empty()) {
+        Log.warningln(F("InfluxLogger has no sinks, readings will be discarded."));
+    }
+    for (LogSink* sink : sinks) {
+        sink->begin();
     }
-    client.setWriteOptions(WriteOptions().writePrecision(WritePrecision::MS).batchSize(500).bufferSize(100));
 }
 
 void InfluxLogger::logSensorResult(const SensorResult& result) {
@@ -56,31 +57,285 @@ void InfluxLogger::logSensorResult(const SensorResult& result) {
         return;
     }
 
-    Point point(result.getSensorName());
-    point.addTag("device", deviceName);
-    for (uint8_t i = 0; i < result.countEntries(); i++) {
-        point.addField(result.getKey(i), result.getValue(i));
+    int64_t timestampMs = currentTimeMs();
+    if (isUrgent(result)) {
+        sendUrgent(result, timestampMs);
+        return;
     }
-    //point.setTime(time(nullptr));
 
-    uint16_t pointLen = client.pointToLineProtocol(point).length();
-    Log.verboseln(F("Logging point to InfluxDB, Length: %d bytes"), pointLen);
-    if(pointLen >= 141000)
-        Log.warningln(F("Point length exceeds warning threshold, this may cause issues."));
-
-    client.writePoint(point);
+    uint32_t droppedBefore = buffer.droppedReadings();
+    if (!buffer.push(result, timestampMs)) {
+        Log.warningln(F("Reading from sensor %s does not fit in the buffer, discarded."), result.getSensorName());
+    }
+    if (buffer.droppedReadings() != droppedBefore)
+        Log.warningln(F("Reading buffer full, %u oldest readings dropped so far."), buffer.droppedReadings());
 }
 
-void InfluxLogger::flush() {
+size_t InfluxLogger::flush() {
     if (simulated) {
         Log.notice(F("Simulated flush, no data sent to InfluxDB."));
+        return 0;
+    }
+    if (buffer.isEmpty()) {
+        return 0;
+    }
+
+    uint16_t maxPoints = batchSize();
+    size_t points = buffer.countReadings() < maxPoints ? buffer.countReadings() : maxPoints;
+
+    std::shared_ptr<EncodedBatch> batch = std::make_shared<EncodedBatch>();
+    batch->body.reserve(buffer.usedBytes() * 2 * points / buffer.countReadings());
+    while (!buffer.isEmpty() && batch->points < points) {
+        if (encodeReading(buffer.front(), batch->body)) {
+            batch->points++;
+        } else {
+            skippedReadings++;
+        }
+        buffer.pop();
+    }
+    if (batch->points == 0) return 0; // Only readings without a valid value
+    batch->createdAt = millis();
+
+    size_t bytes = batch->body.length();
+    Log.verboseln(F("Encoded %u points, %u bytes"), batch->points, bytes);
+
+    // Every sink shares the same encoded buffer
+    EncodedBatchPtr shared = batch;
+    for (LogSink* sink : sinks) {
+        sink->enqueue(shared);
+    }
+    return bytes;
+}
+
+size_t InfluxLogger::streamBacklog(InfluxHttpStream& stream) {
+    if (simulated) {
+        Log.notice(F("Simulated upload, no data sent to InfluxDB."));
+        return 0;
+    }
+    if (buffer.isEmpty() || !stream.begin()) {
+        return 0;
+    }
+
+    size_t points = buffer.countReadings();
+    if (INFLUX_STREAM_MAX_POINTS > 0 && points > INFLUX_STREAM_MAX_POINTS) points = INFLUX_STREAM_MAX_POINTS;
+
+    // One record at a time, read in place: nothing leaves the buffer before InfluxDB acknowledges it
+    String line;
+    line.reserve(128);
+    size_t bytes = 0;
+    ReadingBuffer::Cursor cursor = buffer.front();
+    size_t encoded = 0;
+    for (size_t i = 0; i < points; i++) {
+        line = "";
+        if (encodeReading(cursor, line)) {
+            if (!stream.write(line.c_str(), line.length())) {
+                stream.abort();
+                return bytes;
+            }
+            bytes += line.length();
+            encoded++;
+        }
+        buffer.advance(cursor);
+    }
+
+    // Skipped readings are counted when they leave the buffer, not on every attempt
+    if (stream.finish(encoded)) {
+        skippedReadings += points - encoded;
+        buffer.pop(points);
+    } else if (stream.wasRejected()) {
+        // Sending them again would be rejected again and block every later reading
+        Log.error(F("Dropped %u readings rejected by InfluxDB\n"), points);
+        skippedReadings += points - encoded;
+        buffer.pop(points);
+    }
+    return bytes;
+}
+
+bool InfluxLogger::waitForNetworkSinks(unsigned long timeoutMs) {
+    unsigned long start = millis();
+    for (LogSink* sink : sinks) {
+        if (!sink->requiresNetwork()) continue;
+        while (!sink->isIdle()) {
+            if (sink->getState() == LogSink::State::BACKOFF) break; // Will retry on the next wake
+            if (millis() - start >= timeoutMs) return false;
+            delay(10);
+        }
+    }
+    return true;
+}
+
+uint16_t InfluxLogger::batchSize() const {
+    uint16_t size = 0;
+    for (const LogSink* sink : sinks) {
+        if (!sink->requiresNetwork()) continue;
+        uint16_t sinkSize = sink->getController().batchSize();
+        if (sinkSize > size) size = sinkSize;
+    }
+    return size > 0 ? size : ADAPTIVE_BATCH_INITIAL_POINTS;
+}
+
+unsigned long InfluxLogger::nextFlushDelayMs() const {
+    unsigned long delayMs = ULONG_MAX;
+    for (const LogSink* sink : sinks) {
+        if (!sink->requiresNetwork()) continue;
+        unsigned long sinkDelay = sink->getController().nextFlushDelayMs();
+        if (sinkDelay < delayMs) delayMs = sinkDelay;
+    }
+    return delayMs != ULONG_MAX ? delayMs : LOG_INTERVAL;
+}
+
+bool InfluxLogger::networkSinksFailing() const {
+    bool any = false;
+    for (const LogSink* sink : sinks) {
+        if (!sink->requiresNetwork()) continue;
+        if (sink->getController().getState().consecutiveFailures == 0) return false;
+        any = true;
+    }
+    return any;
+}
+
+bool InfluxLogger::hasBacklog() const {
+    if (simulated || buffer.countReadings() < batchSize()) return false;
+    // Sinks backing off after a failure shed the extra batches through their queue instead
+    bool any = false;
+    for (const LogSink* sink : sinks) {
+        if (sink->getState() == LogSink::State::BACKOFF) continue;
+        if (sink->queuedBatches() > 1) return false;
+        any = true;
+    }
+    return any;
+}
+
+bool InfluxLogger::hasUrgentPending() const {
+    for (const LogSink* sink : sinks) {
+        if (sink->hasUrgent()) return true;
+    }
+    return false;
+}
+
+void InfluxLogger::logSinkStats() const {
+    if (buffer.droppedReadings() > 0) {
+        Log.notice(F("Reading buffer dropped %u readings\n"), buffer.droppedReadings());
+    }
+    if (skippedReadings > 0) {
+        Log.notice(F("%u readings without a finite value not sent\n"), skippedReadings);
+    }
+    for (const LogSink* sink : sinks) {
+        sink->logStats();
+    }
+}
+
+bool InfluxLogger::isUrgent(const SensorResult& result) {
+    uint8_t schemaCount;
+    const FieldSchema* schema = result.getSchema(schemaCount);
+    for (uint8_t i = 0; schema && i < schemaCount; i++) {
+        if (schema[i].priority == FieldPriority::ALARM && result.has(schema[i].key)
+            && schema[i].isUrgent(result.getValue(schema[i].key))) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Encodes a single reading into its own batch and puts it ahead of the bulk
+ * batches of every sink, bypassing the reading buffer and the flush interval.
+ */
+void InfluxLogger::sendUrgent(const SensorResult& result, int64_t timestampMs) {
+    uint8_t schemaCount;
+    const FieldSchema* schema = result.getSchema(schemaCount);
+
+    std::shared_ptr<EncodedBatch> batch = std::make_shared<EncodedBatch>();
+    appendRecordStart(batch->body, result.getSensorName());
+    bool first = true;
+    for (uint8_t i = 0; i < result.countEntries(); i++) {
+        const char* key = result.getKey(i);
+        int decimals = LINE_PROTOCOL_DECIMALS;
+        for (uint8_t j = 0; schema && j < schemaCount; j++) {
+            if (schema[j].isQuantized() && strcmp(schema[j].key, key) == 0) {
+                decimals = schema[j].decimals();
+                break;
+            }
+        }
+        if (appendField(batch->body, first, key, result.getValue(i), decimals)) first = false;
+    }
+    if (first) {
+        Log.warningln(F("Alarm from sensor %s has no valid value, not sent."), result.getSensorName());
         return;
     }
+    appendTimestamp(batch->body, timestampMs);
+    batch->points = 1;
+    batch->createdAt = millis(); // The reading was just taken
+    batch->urgent = true;
+
+    Log.noticeln(F("Alarm from sensor %s, sending immediately."), result.getSensorName());
+    EncodedBatchPtr shared = batch;
+    for (LogSink* sink : sinks) {
+        sink->enqueueUrgent(shared);
+    }
+}
+
+/**
+ * Appends the buffered reading at the cursor as one line protocol record:
+ * measurement,device=<name> key=value,... timestamp
+ */
+bool InfluxLogger::encodeReading(const ReadingBuffer::Cursor& cursor, String& out) {
+    ReadingBuffer::RecordHeader header;
+    buffer.peek(cursor, header);
+
+    size_t start = out.length();
+    appendRecordStart(out, header.sensorName);
+    bool first = true;
+    buffer.forEachField(cursor, [&](const ReadingBuffer::Field& field) {
+        // Quantized fields are printed with exactly the decimals of their scale
+        int decimals = field.decimals >= 0 ? field.decimals : LINE_PROTOCOL_DECIMALS;
+        if (appendField(out, first, field.key, field.value, decimals)) first = false;
+    });
+    if (first) {
+        // A record needs at least one field
+        out.remove(start);
+        return false;
+    }
+    appendTimestamp(out, header.timestampMs);
+    return true;
+}
+
+void InfluxLogger::appendRecordStart(String& out, const char* sensorName) const {
+    appendEscaped(out, sensorName, ", ");
+    out += ",device=";
+    appendEscaped(out, deviceName, ",= ");
+    out += ' ';
+}
+
+bool InfluxLogger::appendField(String& out, bool first, const char* key, float value, int decimals) {
+    // Line protocol has no NaN or infinity: InfluxDB would reject the whole batch
+    if (!isfinite(value)) return false;
+    if (decimals > MAX_FIELD_DECIMALS) decimals = MAX_FIELD_DECIMALS;
+    // '=', sign, up to 39 integer digits of a float, '.', the decimals and the terminator
+    char number[44 + MAX_FIELD_DECIMALS];
+    int length = snprintf(number, sizeof(number), "=%.*f", decimals, value);
+    if (length < 0 || static_cast<size_t>(length) >= sizeof(number)) return false;
+    if (!first) out += ',';
+    appendEscaped(out, key, ",= ");
+    out += number;
+    return true;
+}
 
-    if (!client.flushBuffer()) {
-        Serial.print("InfluxDB flush failed: ");
-        Serial.println(client.getLastErrorMessage());
-        Serial.print("Full buffer: ");
-        Serial.println(client.isBufferFull() ? "Yes" : "No");
+void InfluxLogger::appendTimestamp(String& out, int64_t timestampMs) {
+    char number[24];
+    snprintf(number, sizeof(number), " %lld\n", static_cast<long long>(timestampMs));
+    out += number;
+}
+
+void InfluxLogger::appendEscaped(String& out, const char* value, const char* specialChars) {
+    for (const char* c = value; *c; c++) {
+        if (strchr(specialChars, *c)) out += '\\';
+        out += *c;
     }
 }
+
+int64_t InfluxLogger::currentTimeMs() {
+    struct timeval tv;
+    gettimeofday(&tv, nullptr);
+    return static_cast<int64_t>(tv.tv_sec) * 1000LL + tv.tv_usec / 1000;
+}
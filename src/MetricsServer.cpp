@@ -0,0 +1,111 @@
+#include "MetricsServer.h"
+#include <ArduinoLog.h>
+
+MetricsServer::MetricsServer(const ReadingsSnapshot& snapshot, const char* deviceName, uint16_t port)
+    : snapshot(snapshot), deviceName(deviceName), port(port), server(port) {}
+
+void MetricsServer::begin() {
+    server.on("/metrics", HTTP_GET, [this]() { handlePrometheus(); });
+    server.on("/json", HTTP_GET, [this]() { handleJson(); });
+    server.begin();
+    xTaskCreate(taskEntry, "MetricsServer", METRICS_SERVER_TASK_STACK, this, METRICS_SERVER_TASK_PRIORITY, &task);
+    Log.notice(F("Metrics server listening on port %d\n"), port);
+}
+
+void MetricsServer::handlePrometheus() {
+    size_t count = snapshot.read(fields);
+    unsigned long now = millis();
+
+    String body;
+    body.reserve(64 + count * 160);
+    body += "# HELP openmonitor_reading Latest value of a sensor field.\n";
+    body += "# TYPE openmonitor_reading gauge\n";
+    char number[24];
+    for (size_t i = 0; i < count; i++) {
+        body += "openmonitor_reading{device=\"";
+        appendEscaped(body, deviceName);
+        body += "\",sensor=\"";
+        appendEscaped(body, fields[i].sensorName);
+        body += "\",field=\"";
+        appendEscaped(body, fields[i].key);
+        body += "\"} ";
+        appendPrometheusValue(body, fields[i].value);
+        body += '\n';
+    }
+    body += "# HELP openmonitor_reading_age_seconds Time since the field was last updated.\n";
+    body += "# TYPE openmonitor_reading_age_seconds gauge\n";
+    for (size_t i = 0; i < count; i++) {
+        body += "openmonitor_reading_age_seconds{device=\"";
+        appendEscaped(body, deviceName);
+        body += "\",sensor=\"";
+        appendEscaped(body, fields[i].sensorName);
+        body += "\",field=\"";
+        appendEscaped(body, fields[i].key);
+        snprintf(number, sizeof(number), "\"} %.3f\n", (now - fields[i].updatedAt) / 1000.0f);
+        body += number;
+    }
+    server.send(200, "text/plain; version=0.0.4", body);
+}
+
+void MetricsServer::handleJson() {
+    size_t count = snapshot.read(fields);
+    unsigned long now = millis();
+
+    String body;
+    body.reserve(32 + count * 96);
+    body += "{\"device\":\"";
+    appendEscaped(body, deviceName);
+    body += "\",\"readings\":[";
+    char number[48];
+    bool first = true;
+    for (size_t i = 0; i < count; i++) {
+        if (!isfinite(fields[i].value)) continue; // JSON has no NaN or Infinity
+        if (!first) body += ',';
+        first = false;
+        body += "{\"sensor\":\"";
+        appendEscaped(body, fields[i].sensorName);
+        body += "\",\"field\":\"";
+        appendEscaped(body, fields[i].key);
+        snprintf(number, sizeof(number), "\",\"value\":%g,\"age_ms\":%lu}", fields[i].value, now - fields[i].updatedAt);
+        body += number;
+    }
+    body += "]}";
+    server.send(200, "application/json", body);
+}
+
+/**
+ * Prometheus spells the non-finite values NaN, +Inf and -Inf, which printf does not.
+ */
+void MetricsServer::appendPrometheusValue(String& out, float value) {
+    if (isnan(value)) {
+        out += "NaN";
+    } else if (isinf(value)) {
+        out += value > 0 ? "+Inf" : "-Inf";
+    } else {
+        char number[16];
+        snprintf(number, sizeof(number), "%g", value);
+        out += number;
+    }
+}
+
+/**
+ * Escapes backslashes, quotes and newlines, valid both for Prometheus label values and JSON strings.
+ */
+void MetricsServer::appendEscaped(String& out, const char* value) {
+    for (const char* c = value; *c; c++) {
+        if (*c == '\n') {
+            out += "\\n";
+            continue;
+        }
+        if (*c == '\\' || *c == '"') out += '\\';
+        out += *c;
+    }
+}
+
+void MetricsServer::taskEntry(void* arg) {
+    MetricsServer* metricsServer = static_cast<MetricsServer*>(arg);
+    for (;;) {
+        metricsServer->server.handleClient();
+        vTaskDelay(pdMS_TO_TICKS(METRICS_SERVER_POLL_INTERVAL_MS));
+    }
+}
@@ -0,0 +1,57 @@
+#include "RadioManager.h"
+#include <ArduinoLog.h>
+#include <WiFi.h>
+
+RadioManager::RadioManager(const char* ssid, const char* password) : ssid(ssid), password(password) {}
+
+void RadioManager::begin() {
+    wifiMulti.addAP(ssid, password);
+}
+
+bool RadioManager::wake(unsigned long timeoutMs) {
+    if (awake && WiFi.status() == WL_CONNECTED) {
+        return true;
+    }
+
+    unsigned long start = millis();
+    WiFi.mode(WIFI_STA);
+    awake = true;
+
+    Log.notice(F("Connecting to WiFi...\n"));
+    while (wifiMulti.run() != WL_CONNECTED) {
+        if (millis() - start >= timeoutMs) {
+            stats.failedWakes++;
+            Log.error(F("WiFi connection timed out after %u ms\n"), timeoutMs);
+            return false;
+        }
+        delay(100);
+    }
+
+    stats.wakeCount++;
+    stats.lastReconnectMs = millis() - start;
+    stats.totalReconnectMs += stats.lastReconnectMs;
+    stats.lastUploadBytes = 0;
+    Log.notice(F("Connected to WiFi: %s in %u ms\n"), ssid, stats.lastReconnectMs);
+    return true;
+}
+
+void RadioManager::sleep() {
+    if (!awake) return;
+    WiFi.disconnect(true);
+    WiFi.mode(WIFI_OFF);
+    awake = false;
+    Log.verboseln(F("WiFi radio turned off"));
+}
+
+void RadioManager::recordUpload(size_t bytes) {
+    stats.lastUploadBytes += bytes;
+    stats.totalUploadBytes += bytes;
+}
+
+void RadioManager::logStats() const {
+    uint32_t avgReconnectMs = stats.wakeCount > 0 ? stats.totalReconnectMs / stats.wakeCount : 0;
+    uint32_t avgBytesPerWake = stats.wakeCount > 0 ? static_cast<uint32_t>(stats.totalUploadBytes / stats.wakeCount) : 0;
+    Log.notice(F("Radio: %u wakes (%u failed), reconnect last %u ms avg %u ms, bytes last %u avg %u per wake\n"),
+               stats.wakeCount, stats.failedWakes, stats.lastReconnectMs, avgReconnectMs,
+               static_cast<uint32_t>(stats.lastUploadBytes), avgBytesPerWake);
+}
@@ -2,31 +2,117 @@
 #include <ArduinoLog.h>
 #include <stdexcept>
 
-#include <WiFiMulti.h>
-WiFiMulti wifiMulti;
+#include <WiFi.h>
 #define DEVICE "ESP32"
 
 #include "SensorManager.h"
 
 SensorManager sensorManager;
 
-#include "config.h"
-#include "secrets.h"
+#if ASYNC_LOG_ENABLED
+#include "AsyncLogOutput.h"
+AsyncLogOutput asyncLog(Serial);
+#endif
+
 #include "InfluxLogger.h"
 
 InfluxLogger influxLogger("D0", false);
 
+#include "RulesEngine.h"
+
+RulesEngine rulesEngine;
+
+#include "I2cBus.h"
+
+#if BLOCK_STATS_BENCHMARK
+#include "BlockStats.h"
+#endif
+
+#if STATIC_SENSOR_MANAGER_BENCHMARK
+#include "StaticSensorManager.h"
+#endif
+
+#include "config.h"
+#include "secrets.h"
+#include "RadioManager.h"
+#include "Backoff.h"
+
+RadioManager radio(SECRET_WIFI_SSID, SECRET_WIFI_PASSWORD);
+
+#if METRICS_SERVER_ENABLED
+#include "MetricsServer.h"
+MetricsServer metricsServer(sensorManager.getSnapshot(), "D0");
+#endif
+
 void printPrefix(Print* _logOutput, int logLevel) {
     _logOutput->print("[");
     _logOutput->print(millis() / 1000);
     _logOutput->print("] ");
 }
 
+/**
+ * Brings the radio up, sends everything buffered and turns it off again.
+ * Batches are sent one at a time, so RAM use stays bounded by the batch size; with
+ * INFLUX_STREAM_UPLOAD the buffer is streamed to InfluxDB in a single request instead.
+ */
+void uploadBurst() {
+#if INFLUX_STREAM_UPLOAD
+    if (influxStream.retryInMs() > 0) {
+        // InfluxDB asked to wait (Retry-After): do not wake the radio for nothing
+        Log.notice(F("Upload deferred by %u s, %d readings kept in buffer\n"),
+                   static_cast<uint32_t>(influxStream.retryInMs() / 1000), influxLogger.bufferedReadings());
+        return;
+    }
+#endif
+    if (!radio.wake()) {
+        Log.error(F("Upload skipped, %d readings kept in buffer\n"), influxLogger.bufferedReadings());
+        radio.sleep();
+        return;
+    }
+#if INFLUX_STREAM_UPLOAD
+    // The whole backlog in one request; after a failure it stays buffered for the next wake
+    radio.recordUpload(influxLogger.streamBacklog(influxStream));
+#else
+    while (influxLogger.bufferedReadings() > 0) {
+        radio.recordUpload(influxLogger.flush());
+        if (!influxLogger.waitForNetworkSinks(LOG_SINK_DRAIN_TIMEOUT)) {
+            Log.warning(F("Sinks did not drain before the radio was turned off\n"));
+            break;
+        }
+        if (influxLogger.networkSinksFailing()) {
+            break; // Keep the rest buffered for the next wake
+        }
+    }
+#endif
+    radio.sleep();
+    radio.logStats();
+    influxLogger.logSinkStats();
+#if INFLUX_STREAM_UPLOAD
+    influxStream.logStats();
+#endif
+}
+
+/**
+ * Logs a sensor result and the events of the rules it triggers.
+ */
+void logResult(const SensorResult& result) {
+    influxLogger.logSensorResult(result);
+    rulesEngine.evaluate(result, [](const SensorResult& event) {
+        influxLogger.logSensorResult(event);
+    });
+}
+
 void setup() {
     Serial.begin(115200);
 
     Log.setPrefix(printPrefix);
+#if ASYNC_LOG_ENABLED
+    asyncLog.begin();
+    Log.begin(LOG_LEVEL_TRACE, &asyncLog, false, true);
+    sensorManager.setLogOutput(&asyncLog);
+#else
     Log.begin(LOG_LEVEL_TRACE, &Serial, false, true);
+#endif
 
     WiFi.mode(WIFI_STA);
     /*WiFi.begin(SECRET_WIFI_SSID, SECRET_WIFI_PASSWORD);
@@ -35,33 +121,55 @@ void setup() {
         Log.notice(F("Connecting to WiFi...\n"));
     }*/
 
-    Log.notice(F("Connecting to WiFi...\n"));
-    wifiMulti.addAP(SECRET_WIFI_SSID, SECRET_WIFI_PASSWORD);
-    while (wifiMulti.run() != WL_CONNECTED) {
+    radio.begin();
+    while (!radio.wake()) {
         delay(1000);
-        Log.notice(F("Connecting to WiFi...\n"));
     }
-    Log.notice(F("Connected to WiFi: %s\n"), SECRET_WIFI_SSID);
 
+#if BLOCK_STATS_BENCHMARK
+    if (!BlockStats::benchmark()) {
+        Log.error(F("Block statistics kernels disagree with the scalar reference, sensor statistics are wrong\n"));
+    }
+#endif
+
+    addSinksToLogger();
     influxLogger.begin();
 
     addSensorsToManager();
+    addRulesToEngine();
     sensorManager.beginAll();
+#if STATIC_SENSOR_MANAGER_BENCHMARK
+    staticSensors.benchmark(sensorManager);
+#endif
+#if METRICS_SERVER_ENABLED
+    metricsServer.begin();
+#endif
     std::vector<SensorResult> results = sensorManager.readAll(true); // Force read all sensors to initialize them
     for (const SensorResult& result : results) {
         if (result.isEmpty()) continue; // Skip empty results
         try {
-            influxLogger.logSensorResult(result);
+            logResult(result);
         } catch (const SensorReadException& e) {
             Log.error(F("Error reading sensor '%s': %s\n"), result.getSensorName(), e.what());
         }
     }
 
+#if RADIO_DUTY_CYCLE_ENABLED
+    uploadBurst();
+#endif
+
 }
 
 void loop() {
 
     static unsigned long lastLogTime = 0;
+    static unsigned long lastUploadTime = 0;
+    static unsigned long lastFlushTime = 0;
+#if RADIO_DUTY_CYCLE_ENABLED
+    // A failed wake blocks for up to RADIO_CONNECT_TIMEOUT, so alarms retry with a backoff
+    static Backoff alarmWakeBackoff(RADIO_ALARM_RETRY_MIN_MS, RADIO_WAKE_INTERVAL);
+    static unsigned long alarmWakeAt = 0;
+#endif
 
     unsigned long now = millis();
 
@@ -70,7 +178,7 @@ void loop() {
     for (const SensorResult& result : results) {
         if (result.isEmpty()) continue; // Skip empty results
         try {
-            influxLogger.logSensorResult(result);
+            logResult(result);
         } catch (const SensorReadException& e) {
             Log.error(F("Error reading sensor '%s': %s\n"), result.getSensorName(), e.what());
         }
@@ -78,12 +186,72 @@ void loop() {
 
     if (now - lastLogTime >= LOG_INTERVAL) {
         lastLogTime = now;
-        try {
-            sensorManager.readAndLogAllValues();
-        } catch (const std::exception& e) {
-            Log.error(F("Error occurred while logging sensor values: %s\n"), e.what());
+        sensorManager.logLatestValues(); // Values of the last readAll(), without reading the sensors again
+#if LIGHT_SLEEP_ENABLED
+        sensorManager.logSleepStats();
+#endif
+        sensorManager.logHealth();
+        rulesEngine.logStats();
+        I2cBus::logAllStats();
+        Log.notice(F("Heap: %u free, %u minimum free, %u largest block, %u readings buffered\n"),
+                   ESP.getFreeHeap(), ESP.getMinFreeHeap(), ESP.getMaxAllocHeap(), influxLogger.bufferedReadings());
+#if WINDOW_STATS_LOG_WINDOW_MS > 0
+        sensorManager.getWindowStats().log(WINDOW_STATS_LOG_WINDOW_MS);
+#endif
+#if !RADIO_DUTY_CYCLE_ENABLED
+        influxLogger.logSinkStats(); // Logged after each upload burst otherwise
+#endif
+    }
+
+#if !RADIO_DUTY_CYCLE_ENABLED
+    if (now - lastFlushTime >= influxLogger.nextFlushDelayMs() || influxLogger.hasBacklog()) {
+        lastFlushTime = now;
+        if (radio.wake()) { // Reconnects if the connection was lost
+            radio.recordUpload(influxLogger.flush());
+        }
+    }
+#endif
+
+#if RADIO_DUTY_CYCLE_ENABLED
+    if (influxLogger.hasUrgentPending() && static_cast<long>(now - alarmWakeAt) >= 0) {
+        // Alarms do not wait for the next scheduled wake
+        if (radio.wake()) {
+            influxLogger.waitForNetworkSinks(LOG_SINK_DRAIN_TIMEOUT);
         }
-        influxLogger.flush();
+        radio.sleep();
+        if (influxLogger.hasUrgentPending()) {
+            unsigned long delayMs = alarmWakeBackoff.next();
+            alarmWakeAt = millis() + delayMs;
+            Log.warning(F("Alarm not delivered, next attempt in %u ms\n"), delayMs);
+        } else {
+            alarmWakeBackoff.reset();
+        }
+    }
+    if (now - lastUploadTime >= RADIO_WAKE_INTERVAL || influxLogger.bufferedReadings() >= RADIO_WAKE_BUFFER_THRESHOLD) {
+        lastUploadTime = now;
+        uploadBurst();
+    }
+#endif
+
+#if LIGHT_SLEEP_ENABLED
+    unsigned long sinceLog = millis() - lastLogTime;
+    unsigned long maxSleepMs = sinceLog >= LOG_INTERVAL ? 0 : LOG_INTERVAL - sinceLog;
+#if RADIO_DUTY_CYCLE_ENABLED
+    unsigned long sinceUpload = millis() - lastUploadTime;
+    unsigned long untilUpload = sinceUpload >= RADIO_WAKE_INTERVAL ? 0 : RADIO_WAKE_INTERVAL - sinceUpload;
+    if (untilUpload < maxSleepMs) maxSleepMs = untilUpload;
+    if (influxLogger.hasUrgentPending()) {
+        long untilAlarmWake = static_cast<long>(alarmWakeAt - millis());
+        if (untilAlarmWake < 0) untilAlarmWake = 0;
+        if (static_cast<unsigned long>(untilAlarmWake) < maxSleepMs) maxSleepMs = untilAlarmWake;
     }
+#else
+    unsigned long sinceFlush = millis() - lastFlushTime;
+    unsigned long flushDelay = influxLogger.nextFlushDelayMs();
+    unsigned long untilFlush = sinceFlush >= flushDelay ? 0 : flushDelay - sinceFlush;
+    if (untilFlush < maxSleepMs) maxSleepMs = untilFlush;
+#endif
+    sensorManager.sleepUntilNextDeadline(maxSleepMs);
+#endif
 
 }
\ No newline at end of file
@@ -0,0 +1,21 @@
+#pragma once
+// Minimal Arduino API for the host unit tests (pio test -e native). Only what the libraries
+// under test use; the firmware builds against the real core.
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <math.h>
+#include <chrono>
+
+#define IRAM_ATTR
+#define F(text) text
+
+class EspClass {
+public:
+    // Host stand-in for the CPU cycle counter: nanoseconds of the steady clock
+    uint32_t getCycleCount() {
+        return static_cast<uint32_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+    }
+};
+
+inline EspClass ESP;
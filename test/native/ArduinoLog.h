@@ -0,0 +1,21 @@
+#pragma once
+// ArduinoLog stand-in for the host unit tests: log calls compile and do nothing.
+
+#define CR "\n"
+
+class Logging {
+public:
+    template<typename... Args> void fatal(Args...) {}
+    template<typename... Args> void error(Args...) {}
+    template<typename... Args> void warning(Args...) {}
+    template<typename... Args> void notice(Args...) {}
+    template<typename... Args> void trace(Args...) {}
+    template<typename... Args> void verbose(Args...) {}
+    template<typename... Args> void errorln(Args...) {}
+    template<typename... Args> void warningln(Args...) {}
+    template<typename... Args> void noticeln(Args...) {}
+    template<typename... Args> void traceln(Args...) {}
+    template<typename... Args> void verboseln(Args...) {}
+};
+
+inline Logging Log;
@@ -0,0 +1,150 @@
+#include <unity.h>
+#include <math.h>
+#include <vector>
+#include "BlockStats.h"
+
+static uint32_t nextRandom(uint32_t& state) {
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+static void assertClose(float expected, float actual) {
+    TEST_ASSERT_FLOAT_WITHIN(1e-5f * fmaxf(1.0f, fabsf(expected)), expected, actual);
+}
+
+static void assertAgree(const BlockStats& reference, const BlockStats& kernel) {
+    TEST_ASSERT_EQUAL_UINT32(reference.count(), kernel.count());
+    assertClose(reference.sum(), kernel.sum());
+    assertClose(reference.sumSquares(), kernel.sumSquares());
+    TEST_ASSERT_EQUAL_FLOAT(reference.min(), kernel.min());
+    TEST_ASSERT_EQUAL_FLOAT(reference.max(), kernel.max());
+    assertClose(reference.absMean(), kernel.absMean());
+    assertClose(reference.absPeak(), kernel.absPeak());
+}
+
+/**
+ * Every length from 0 to 19 covers the unrolled body alone, the tail alone and both.
+ */
+static void test_float_kernel_matches_scalar() {
+    uint32_t state = 1;
+    std::vector<float> samples(19);
+    for (size_t count = 0; count < samples.size(); count++) {
+        for (float& sample : samples) sample = 9.81f + (static_cast<int32_t>(nextRandom(state) & 0xFFFF) - 32768) * 1e-4f;
+        BlockStats reference(9.81f), kernel(9.81f);
+        reference.addScalar(samples.data(), count);
+        kernel.add(samples.data(), count);
+        assertAgree(reference, kernel);
+    }
+}
+
+static void test_float_kernel_accumulates_blocks() {
+    uint32_t state = 2;
+    std::vector<float> samples(1000);
+    for (float& sample : samples) sample = (static_cast<int32_t>(nextRandom(state) & 0xFFFF) - 32768) * 1e-3f;
+    BlockStats reference, kernel;
+    reference.addScalar(samples.data(), samples.size());
+    // Blocks of uneven lengths, as a signal arrives
+    for (size_t offset = 0, length = 1; offset < samples.size(); offset += length, length = length * 2 + 1) {
+        if (offset + length > samples.size()) length = samples.size() - offset;
+        kernel.add(samples.data() + offset, length);
+    }
+    assertAgree(reference, kernel);
+}
+
+/**
+ * The uint16 kernel works on doubled deviations, so a center ending in .5 stays exact.
+ */
+static void test_adc_kernel_matches_scalar() {
+    uint32_t state = 3;
+    std::vector<uint16_t> codes(19);
+    std::vector<float> asFloat(codes.size());
+    for (float center : {0.0f, 2047.5f, 2048.0f}) {
+        for (size_t count = 0; count < codes.size(); count++) {
+            for (size_t i = 0; i < codes.size(); i++) {
+                codes[i] = nextRandom(state) & 0x0FFF;
+                asFloat[i] = codes[i];
+            }
+            BlockStats reference(center), kernel(center);
+            reference.addScalar(asFloat.data(), count);
+            kernel.add(codes.data(), count);
+            assertAgree(reference, kernel);
+        }
+    }
+}
+
+static void test_adc_half_center() {
+    const uint16_t codes[] = {2047, 2048, 2047, 2048, 0, 4095};
+    BlockStats stats(2047.5f);
+    stats.add(codes, 4);
+    TEST_ASSERT_EQUAL_FLOAT(0.5f, stats.absMean());
+    TEST_ASSERT_EQUAL_FLOAT(0.5f, stats.absPeak());
+    stats.add(codes + 4, 2);
+    TEST_ASSERT_EQUAL_FLOAT(2047.5f, stats.absPeak());
+    TEST_ASSERT_EQUAL_FLOAT((4 * 0.5f + 2 * 2047.5f) / 6, stats.absMean());
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, stats.min());
+    TEST_ASSERT_EQUAL_FLOAT(4095.0f, stats.max());
+}
+
+/**
+ * Longer than one integer chunk of the uint16 kernel, with full scale 16-bit codes.
+ */
+static void test_adc_kernel_long_block() {
+    uint32_t state = 4;
+    std::vector<uint16_t> codes(40001);
+    std::vector<float> asFloat(codes.size());
+    for (size_t i = 0; i < codes.size(); i++) {
+        codes[i] = nextRandom(state) & 0xFFFF;
+        asFloat[i] = codes[i];
+    }
+    BlockStats reference(32767.5f), kernel(32767.5f);
+    reference.addScalar(asFloat.data(), asFloat.size());
+    kernel.add(codes.data(), codes.size());
+    TEST_ASSERT_EQUAL_UINT32(reference.count(), kernel.count());
+    // The float reference accumulates rounding errors, the integer kernel does not
+    TEST_ASSERT_FLOAT_WITHIN(1e-3f * reference.sum(), reference.sum(), kernel.sum());
+    TEST_ASSERT_FLOAT_WITHIN(1e-3f * reference.sumSquares(), reference.sumSquares(), kernel.sumSquares());
+    TEST_ASSERT_FLOAT_WITHIN(1e-3f * reference.absMean(), reference.absMean(), kernel.absMean());
+    TEST_ASSERT_EQUAL_FLOAT(reference.absPeak(), kernel.absPeak());
+    TEST_ASSERT_EQUAL_FLOAT(reference.min(), kernel.min());
+    TEST_ASSERT_EQUAL_FLOAT(reference.max(), kernel.max());
+}
+
+static void test_derived_statistics() {
+    const float samples[] = {1.0f, 2.0f, 3.0f, 4.0f, 5.0f};
+    BlockStats stats(3.0f);
+    stats.add(samples, 5);
+    TEST_ASSERT_EQUAL_FLOAT(3.0f, stats.mean());
+    TEST_ASSERT_EQUAL_FLOAT(2.0f, stats.variance());
+    TEST_ASSERT_EQUAL_FLOAT(sqrtf(11.0f), stats.rms());
+    TEST_ASSERT_EQUAL_FLOAT(4.0f, stats.peakToPeak());
+    TEST_ASSERT_EQUAL_FLOAT(1.2f, stats.absMean());
+    TEST_ASSERT_EQUAL_FLOAT(2.0f, stats.absPeak());
+
+    stats.reset();
+    TEST_ASSERT_EQUAL_UINT32(0, stats.count());
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, stats.mean());
+}
+
+/**
+ * The on-target benchmark runs the same agreement check; its timings are meaningless here.
+ */
+static void test_benchmark_check_passes() {
+    TEST_ASSERT_TRUE(BlockStats::benchmark());
+}
+
+void setUp() {}
+void tearDown() {}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_float_kernel_matches_scalar);
+    RUN_TEST(test_float_kernel_accumulates_blocks);
+    RUN_TEST(test_adc_kernel_matches_scalar);
+    RUN_TEST(test_adc_half_center);
+    RUN_TEST(test_adc_kernel_long_block);
+    RUN_TEST(test_derived_statistics);
+    RUN_TEST(test_benchmark_check_passes);
+    return UNITY_END();
+}
@@ -0,0 +1,131 @@
+#include <unity.h>
+#include <math.h>
+#include <vector>
+#include "RealFft.h"
+
+// Reproducible noise in [-1, 1)
+static float nextNoise(uint32_t& state) {
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return static_cast<int32_t>(state >> 8 & 0xFFFF) / 32768.0f - 1.0f;
+}
+
+static std::vector<float> noise(size_t size, uint32_t seed) {
+    std::vector<float> samples(size);
+    for (float& sample : samples) sample = nextNoise(seed);
+    return samples;
+}
+
+/**
+ * Compares forward() with a direct DFT in double precision, bin by bin, in the packed layout.
+ */
+static void checkAgainstDft(size_t size) {
+    RealFft fft(size);
+    std::vector<float> input = noise(size, 12345 + size);
+    std::vector<float> data = input;
+    fft.forward(data.data());
+
+    double maxError = 0.0;
+    for (size_t k = 0; k <= size / 2; k++) {
+        double re = 0.0, im = 0.0;
+        for (size_t i = 0; i < size; i++) {
+            double angle = -2.0 * M_PI * static_cast<double>(k * i % size) / size;
+            re += input[i] * cos(angle);
+            im += input[i] * sin(angle);
+        }
+        double error;
+        if (k == 0) {
+            error = fabs(data[0] - re);
+        } else if (k == size / 2) {
+            error = fabs(data[1] - re);
+        } else {
+            error = fmax(fabs(data[2 * k] - re), fabs(data[2 * k + 1] - im));
+        }
+        if (error > maxError) maxError = error;
+    }
+    // Relative to sqrt(N), the typical magnitude of a bin of noise
+    TEST_ASSERT_LESS_THAN_DOUBLE(2e-6, maxError / sqrt(static_cast<double>(size)));
+}
+
+static void test_matches_dft_16() { checkAgainstDft(16); }
+static void test_matches_dft_256() { checkAgainstDft(256); }
+static void test_matches_dft_1024() { checkAgainstDft(1024); }
+
+static void test_smallest_size() {
+    RealFft fft(4);
+    float data[4] = {1.0f, 2.0f, 3.0f, 4.0f};
+    fft.forward(data);
+    // X = {10, -2+2i, -2}
+    TEST_ASSERT_FLOAT_WITHIN(1e-6f, 10.0f, data[0]);
+    TEST_ASSERT_FLOAT_WITHIN(1e-6f, -2.0f, data[1]);
+    TEST_ASSERT_FLOAT_WITHIN(1e-6f, -2.0f, data[2]);
+    TEST_ASSERT_FLOAT_WITHIN(1e-6f, 2.0f, data[3]);
+}
+
+/**
+ * The bin powers of a windowed signal add up to its mean square, corrected for the window.
+ */
+static void test_parseval() {
+    const size_t size = 1024;
+    RealFft fft(size);
+    std::vector<float> data = noise(size, 777);
+    for (size_t i = 0; i < size; i++) data[i] += 3.0f; // DC offset, removed by the window
+    fft.applyWindow(data.data());
+
+    double windowedSquares = 0.0, windowSquares = 0.0;
+    for (size_t i = 0; i < size; i++) {
+        double w = 0.5 - 0.5 * cos(2.0 * M_PI * i / size);
+        windowedSquares += static_cast<double>(data[i]) * data[i];
+        windowSquares += w * w;
+    }
+    double expected = windowedSquares / windowSquares;
+
+    fft.forward(data.data());
+    double total = 0.0;
+    for (size_t k = 0; k <= size / 2; k++) total += fft.binPower(data.data(), k);
+
+    TEST_ASSERT_DOUBLE_WITHIN(1e-4 * expected, expected, total);
+    TEST_ASSERT_FLOAT_WITHIN(1e-3f, 0.0f, fft.binPower(data.data(), 0));
+}
+
+/**
+ * A sine centered on a bin: its power, A^2 / 2, lands in that bin and the two the Hann
+ * window leaks into.
+ */
+static void test_tone_power() {
+    const size_t size = 256;
+    const size_t bin = 20;
+    const float amplitude = 2.0f;
+    RealFft fft(size);
+    std::vector<float> data(size);
+    for (size_t i = 0; i < size; i++) data[i] = amplitude * sinf(2.0f * static_cast<float>(M_PI) * bin * i / size);
+    fft.applyWindow(data.data());
+    fft.forward(data.data());
+
+    float tone = 0.0f, rest = 0.0f;
+    for (size_t k = 0; k <= size / 2; k++) {
+        float power = fft.binPower(data.data(), k);
+        if (k + 1 >= bin && k <= bin + 1) {
+            tone += power;
+        } else {
+            rest += power;
+        }
+    }
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, amplitude * amplitude / 2.0f, tone);
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, 0.0f, rest);
+}
+
+void setUp() {}
+void tearDown() {}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_smallest_size);
+    RUN_TEST(test_matches_dft_16);
+    RUN_TEST(test_matches_dft_256);
+    RUN_TEST(test_matches_dft_1024);
+    RUN_TEST(test_parseval);
+    RUN_TEST(test_tone_power);
+    return UNITY_END();
+}
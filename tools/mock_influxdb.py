@@ -0,0 +1,348 @@
+#!/usr/bin/env python3
+"""Stand-in for the InfluxDB v2 write API, to benchmark the upload path end to end.
+
+Accepts POST /api/v2/write like InfluxDB does (204 on success) and can add latency,
+fail a share of the requests and throttle with 429 + Retry-After, so the retry and
+backoff behaviour of the device can be measured under failure.
+
+Every few seconds it prints the accepted points/s and bytes/s; on exit (Ctrl+C or
+--duration) it prints a summary with:
+  - requests by status code, points and bytes accepted, duplicates
+  - delivery latency percentiles: receive time minus the timestamp of each point,
+    i.e. how long a reading waited on the device (needs the device clock synced by NTP)
+  - loss: readings missing from the "seq" field of SyntheticSensor series
+GET /stats returns the same summary as JSON, with the number of connections and, over
+TLS, of handshakes resumed from a session: a device reusing its connections shows few
+connections for many requests.
+
+For HTTPS, give a certificate (the device does not verify it), e.g.:
+    openssl req -x509 -newkey ec -pkeyopt ec_paramgen_curve:prime256v1 -nodes \
+        -keyout key.pem -out cert.pem -days 365 -subj /CN=mock-influxdb
+    python3 tools/mock_influxdb.py --tls-cert cert.pem --tls-key key.pem
+
+Only the standard library is needed:
+    python3 tools/mock_influxdb.py --port 8086 --latency-ms 50 --error-rate 0.1
+"""
+
+import argparse
+import json
+import math
+import random
+import re
+import ssl
+import threading
+import time
+from http.server import BaseHTTPRequestHandler, ThreadingHTTPServer
+from urllib.parse import parse_qs, urlparse
+
+PRECISION_TO_MS = {"ns": 1e-6, "us": 1e-3, "ms": 1.0, "s": 1000.0}
+
+# Splits a line protocol record on the unescaped spaces: series, fields, timestamp
+UNESCAPED_SPACE = re.compile(r"(?<!\\) ")
+
+
+def percentile(sorted_values, q):
+    if not sorted_values:
+        return 0
+    rank = max(1, math.ceil(q / 100.0 * len(sorted_values)))
+    return sorted_values[rank - 1]
+
+
+class Stats:
+    def __init__(self):
+        self.lock = threading.Lock()
+        self.started = time.time()
+        self.requests = {}          # status code -> count
+        self.points = 0
+        self.bytes = 0
+        self.duplicates = 0
+        self.rejected_points = 0    # in requests answered with an error
+        self.seen = set()           # (series, timestamp)
+        self.latencies_ms = []
+        self.sequences = {}         # series -> set of seq values
+        self.window_points = 0
+        self.window_bytes = 0
+        self.connections = 0
+        self.tls_resumed = 0
+        self.handshake_ms = []
+
+    def count_request(self, code):
+        with self.lock:
+            self.requests[code] = self.requests.get(code, 0) + 1
+
+    def add_connection(self, handshake_ms=None, resumed=False):
+        with self.lock:
+            self.connections += 1
+            if handshake_ms is not None:
+                self.handshake_ms.append(handshake_ms)
+            if resumed:
+                self.tls_resumed += 1
+
+    def add_rejected(self, points):
+        with self.lock:
+            self.rejected_points += points
+
+    def add_batch(self, records, size, received_ms):
+        with self.lock:
+            self.bytes += size
+            self.window_bytes += size
+            for series, fields, timestamp_ms in records:
+                key = (series, timestamp_ms)
+                if key in self.seen:
+                    self.duplicates += 1
+                    continue
+                self.seen.add(key)
+                self.points += 1
+                self.window_points += 1
+                if timestamp_ms is not None:
+                    self.latencies_ms.append(max(0.0, received_ms - timestamp_ms))
+                seq = fields.get("seq")
+                if seq is not None:
+                    self.sequences.setdefault(series, set()).add(int(seq))
+
+    def take_window(self):
+        with self.lock:
+            points, size = self.window_points, self.window_bytes
+            self.window_points = self.window_bytes = 0
+        return points, size
+
+    def summary(self):
+        with self.lock:
+            elapsed = max(time.time() - self.started, 1e-9)
+            latencies = sorted(self.latencies_ms)
+            handshakes = sorted(self.handshake_ms)
+            loss = {}
+            for series, values in self.sequences.items():
+                expected = max(values) + 1
+                loss[series] = {
+                    "expected": expected,
+                    "received": len(values),
+                    "lost": expected - len(values),
+                    "loss_pct": round(100.0 * (expected - len(values)) / expected, 3),
+                }
+            return {
+                "elapsed_s": round(elapsed, 1),
+                "requests": {str(code): n for code, n in sorted(self.requests.items())},
+                "connections": self.connections,
+                "tls": {
+                    "handshakes": len(handshakes),
+                    "resumed": self.tls_resumed,
+                    "handshake_ms_p50": round(percentile(handshakes, 50), 1),
+                    "handshake_ms_max": round(handshakes[-1], 1) if handshakes else 0,
+                },
+                "points": self.points,
+                "bytes": self.bytes,
+                "points_per_s": round(self.points / elapsed, 1),
+                "bytes_per_s": round(self.bytes / elapsed, 1),
+                "duplicates": self.duplicates,
+                "rejected_points": self.rejected_points,
+                "latency_ms": {
+                    "p50": round(percentile(latencies, 50)),
+                    "p90": round(percentile(latencies, 90)),
+                    "p99": round(percentile(latencies, 99)),
+                    "max": round(latencies[-1]) if latencies else 0,
+                },
+                "loss": loss,
+            }
+
+
+def parse_line_protocol(body, precision):
+    """Returns (series, fields, timestamp in ms) for every record of the batch."""
+    scale = PRECISION_TO_MS.get(precision, 1e-6)
+    records = []
+    for line in body.splitlines():
+        line = line.strip()
+        if not line or line.startswith("#"):
+            continue
+        parts = UNESCAPED_SPACE.split(line)
+        if len(parts) < 2:
+            raise ValueError("invalid line: " + line[:80])
+        series, field_set = parts[0], parts[1]
+        timestamp_ms = int(parts[2]) * scale if len(parts) > 2 else None
+        fields = {}
+        for field in field_set.split(","):
+            name, _, value = field.partition("=")
+            try:
+                fields[name] = float(value.rstrip("i"))
+            except ValueError:
+                pass  # Strings and booleans are not needed here
+        records.append((series, fields, timestamp_ms))
+    return records
+
+
+class TokenBucket:
+    """Admits up to rate points per second, with one second of burst."""
+
+    def __init__(self, rate):
+        self.rate = rate
+        self.tokens = rate
+        self.updated = time.monotonic()
+        self.lock = threading.Lock()
+
+    def take(self, points):
+        with self.lock:
+            now = time.monotonic()
+            self.tokens = min(self.rate, self.tokens + (now - self.updated) * self.rate)
+            self.updated = now
+            # A batch larger than one second of budget passes once the bucket is full
+            if self.tokens < min(points, self.rate):
+                return False
+            self.tokens -= points
+            return True
+
+
+def make_handler(args, stats, bucket):
+    class Handler(BaseHTTPRequestHandler):
+        protocol_version = "HTTP/1.1"  # Keep-alive, like InfluxDB
+
+        def setup(self):
+            # Over TLS the handshake runs here, in the connection's thread
+            if isinstance(self.request, ssl.SSLSocket):
+                start = time.time()
+                try:
+                    self.request.do_handshake()
+                except (ssl.SSLError, OSError) as e:
+                    if args.verbose:
+                        print("TLS handshake failed: %s" % e, flush=True)
+                    raise
+                stats.add_connection((time.time() - start) * 1000.0, self.request.session_reused)
+            else:
+                stats.add_connection()
+            super().setup()
+
+        def log_message(self, fmt, *log_args):
+            if args.verbose:
+                super().log_message(fmt, *log_args)
+
+        def reply(self, code, body=b"", content_type="application/json", headers=None):
+            if self.command == "POST":
+                stats.count_request(code)
+            self.send_response(code)
+            for name, value in (headers or {}).items():
+                self.send_header(name, value)
+            if body:
+                self.send_header("Content-Type", content_type)
+            self.send_header("Content-Length", str(len(body)))
+            self.end_headers()
+            if body:
+                self.wfile.write(body)
+
+        def error(self, code, message, headers=None):
+            body = json.dumps({"code": "mock", "message": message}).encode()
+            self.reply(code, body, headers=headers)
+
+        def do_GET(self):
+            path = urlparse(self.path).path
+            if path == "/stats":
+                self.reply(200, json.dumps(stats.summary(), indent=2).encode())
+            elif path in ("/health", "/ping"):
+                self.reply(200, b'{"status":"pass"}')
+            else:
+                self.error(404, "not found")
+
+        def read_chunked(self):
+            """Body of a request sent with chunked transfer encoding (InfluxHttpStream)."""
+            body = bytearray()
+            while True:
+                size = int(self.rfile.readline().split(b";")[0].strip(), 16)
+                if size == 0:
+                    # Trailers, up to the empty line
+                    while self.rfile.readline().strip():
+                        pass
+                    return bytes(body)
+                body += self.rfile.read(size)
+                self.rfile.readline()
+
+        def do_POST(self):
+            url = urlparse(self.path)
+            if self.headers.get("Transfer-Encoding", "").lower() == "chunked":
+                body = self.read_chunked()
+            else:
+                body = self.rfile.read(int(self.headers.get("Content-Length", 0)))
+            if url.path != "/api/v2/write":
+                self.error(404, "not found")
+                return
+            received_ms = time.time() * 1000.0
+
+            if args.token and self.headers.get("Authorization") != "Token " + args.token:
+                self.error(401, "unauthorized access")
+                return
+            query = parse_qs(url.query)
+            try:
+                records = parse_line_protocol(body.decode("utf-8"), query.get("precision", ["ns"])[0])
+            except (UnicodeDecodeError, ValueError) as e:
+                self.error(400, str(e))
+                return
+
+            delay = args.latency_ms + random.uniform(0, args.jitter_ms)
+            if delay > 0:
+                time.sleep(delay / 1000.0)
+
+            if random.random() < args.error_rate:
+                stats.add_rejected(len(records))
+                self.error(503 if random.random() < 0.5 else 500, "injected failure")
+                return
+            if random.random() < args.throttle_rate or (bucket and not bucket.take(len(records))):
+                stats.add_rejected(len(records))
+                self.error(429, "injected throttling", {"Retry-After": str(args.retry_after)})
+                return
+
+            stats.add_batch(records, len(body), received_ms)
+            self.reply(204)
+
+    return Handler
+
+
+def report(stats, interval, stop):
+    while not stop.wait(interval):
+        points, size = stats.take_window()
+        s = stats.summary()
+        print("%6.0f s  %8.1f points/s  %10.1f bytes/s  total %d points, latency p50 %d ms p99 %d ms"
+              % (s["elapsed_s"], points / interval, size / interval, s["points"],
+                 s["latency_ms"]["p50"], s["latency_ms"]["p99"]), flush=True)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n")[0])
+    parser.add_argument("--host", default="0.0.0.0")
+    parser.add_argument("--port", type=int, default=8086)
+    parser.add_argument("--token", default="", help="require this token (any token is accepted if empty)")
+    parser.add_argument("--latency-ms", type=float, default=0, help="added to every write")
+    parser.add_argument("--jitter-ms", type=float, default=0, help="random extra latency, up to this value")
+    parser.add_argument("--error-rate", type=float, default=0, help="share of writes failed with 500 or 503")
+    parser.add_argument("--throttle-rate", type=float, default=0, help="share of writes answered with 429")
+    parser.add_argument("--max-points-per-sec", type=float, default=0, help="throttle above this rate (0 = unlimited)")
+    parser.add_argument("--retry-after", type=int, default=1, help="Retry-After of the 429 answers, in s")
+    parser.add_argument("--report-interval", type=float, default=5, help="s between the progress lines")
+    parser.add_argument("--duration", type=float, default=0, help="stop after this many s (0 = until Ctrl+C)")
+    parser.add_argument("--seed", type=int, default=None, help="seed of the injected failures")
+    parser.add_argument("--verbose", action="store_true", help="log every request")
+    parser.add_argument("--tls-cert", default="", help="serve HTTPS with this certificate (PEM)")
+    parser.add_argument("--tls-key", default="", help="private key of --tls-cert (PEM)")
+    args = parser.parse_args()
+
+    random.seed(args.seed)
+    stats = Stats()
+    bucket = TokenBucket(args.max_points_per_sec) if args.max_points_per_sec > 0 else None
+    server = ThreadingHTTPServer((args.host, args.port), make_handler(args, stats, bucket))
+    server.daemon_threads = True
+    if args.tls_cert:
+        context = ssl.SSLContext(ssl.PROTOCOL_TLS_SERVER)
+        context.load_cert_chain(args.tls_cert, args.tls_key or None)
+        server.socket = context.wrap_socket(server.socket, server_side=True, do_handshake_on_connect=False)
+
+    stop = threading.Event()
+    threading.Thread(target=report, args=(stats, args.report_interval, stop), daemon=True).start()
+    threading.Thread(target=server.serve_forever, daemon=True).start()
+    print("Mock InfluxDB listening on %s://%s:%d" % ("https" if args.tls_cert else "http", args.host, args.port), flush=True)
+    try:
+        stop.wait(args.duration if args.duration > 0 else None)
+    except KeyboardInterrupt:
+        pass
+    stop.set()
+    server.shutdown()
+    print(json.dumps(stats.summary(), indent=2))
+
+
+if __name__ == "__main__":
+    main()